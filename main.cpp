@@ -1,9 +1,21 @@
+#include <future>
 #include <iostream>
 #include <thread>
 #include "LogM.h"
 #include "DBConnPool.h"
+#include "DBRouter.h"
 #include "RecvProc.h"
+#include "AdminProc.h"
 #include "EventLoop.h"
+#include "UserSessionCB.h"
+#include "SessionSnapshot.h"
+#include "ShutdownHooks.h"
+#include "QueryUserData.h"
+#include "PlayerTables.h"
+#include "PlayerLoader.h"
+#include "WriteBehindStore.h"
+#include "RowLog.h"
+#include "StorageBackend.h"
 #include <sodium.h>
 
 using namespace std;
@@ -20,22 +32,59 @@ int main()
     // 设置日志级别
     LogM::getInstance().setLevel(DEBUG);
     
+    // GS_STORAGE=memory 时用户和玩家数据都在进程内，不连 MySQL（单机压测用）
+    bool useMysql = ConfiguredStorage() == StorageKind::MYSQL;
+
     // 数据库连接是个较慢的操作，建议程序启动时就初始化连接池
     string pwd;
-    cout<<"请输入数据库密码:"<<endl;
-    cin>>pwd;
-    
-    DBConnInfo userDbInfo{"tcp://127.0.0.1:3306", "root", pwd, "userdb"};
-    auto& userPool = GetUserDBPool(userDbInfo);
+    if (useMysql) {
+        cout<<"请输入数据库密码:"<<endl;
+        cin>>pwd;
+    }
+
+    // 之后创建的线程都继承这个信号屏蔽字，SIGINT/SIGTERM 只由快照线程接收
+    BlockShutdownSignals();
     
-    DBConnInfo gameDbInfo{"tcp://127.0.0.1:3306", "root", pwd, "gamedb"};
-    auto& gamePool = GetGameDBPool(gameDbInfo);
+    if (useMysql) {
+        DBConnInfo userDbInfo{"tcp://127.0.0.1:3306", "root", pwd, "userdb"};
+        GetUserDBPool(userDbInfo);
 
-    EventLoop eventLoop;
-    g_eventLoop = &eventLoop;
-    std::thread eventThread([&eventLoop]() {
+        DBConnInfo gameDbInfo{"tcp://127.0.0.1:3306", "root", pwd, "gamedb"};
+        GetGameDBRouter(gameDbInfo);
+    }
+
+    // 注册时用来跳过大部分“用户名是否存在”查询，加载失败时注册退回到先查库
+    LoadUsernameFilter();
+
+    // EventLoop 以构造它的线程作为 loop 线程，所以要在运行 loop() 的线程里构造
+    std::promise<EventLoop*> loopReady;
+    std::thread eventThread([&loopReady]() {
+        EventLoop eventLoop;
+        loopReady.set_value(&eventLoop);
         eventLoop.loop();
     });
+    g_eventLoop = loopReady.get_future().get();
+
+    // 会话过期由 loop 上的时间轮驱动，必须在开始接受登录之前挂上
+    UserSessionManager::getInstance().startExpiry(g_eventLoop);
+    // 热重启：恢复上次退出前的会话，客户端凭 resumeToken 直接挂回，不必重新登录
+    string snapshotPath = SessionSnapshotPath();
+    LoadSessionSnapshot(snapshotPath);
+    StartSessionSnapshotter(snapshotPath, std::chrono::seconds(60));
+    // 玩家数据写回 gamedb，退出前把还没落库的脏行刷掉；上次崩溃时没落库的改动先从预写日志补回去
+    GetPlayerStore();
+    ReplayPlayerLog();
+    AddShutdownHook([]() {
+        // 还在对象上的脏字段（含被拒收的新建角色）先交给写回存储，才能被最后一次 flush 带走
+        OnlinePlayers::getInstance().saveOnShutdown(g_eventLoop, std::chrono::seconds(5));
+        GetPlayerStore().stop();
+        if (RowLog* log = GetPlayerLog()) log->stop();
+    });
+    // 下线玩家的内存对象在改动落库后释放
+    OnlinePlayers::getInstance().startSweep(g_eventLoop);
+
+    // 管理端口（健康检查等），与登录端口共用 HttpRouter/ServeHttp
+    std::thread([]() { ProcAdminReq(9100); }).detach();
 
     // 启动登录服务器
     ProcLoginReq(9000);
@@ -54,8 +103,16 @@ int main()
 
 2. 重要函数
     发消息给客户端的函数 
-        - send_json_response  登录线程里给 HTTP 客户端回一次响应：现在用 send_json_response 最省事。
-        - EventLoop::sendToClient 已经交给 g_eventLoop 管理的连接：更推荐只用 sendToClient（避免混用阻塞直写与 EventLoop 写缓冲）
+        - ResponseSink  登录线程里给 HTTP 客户端回响应：已归属 loop 的连接走 loop 写缓冲，
+                        否则非阻塞直写，写不完再交给 loop 续写，不会阻塞工作线程
+        - EventLoop::sendToClient 已经交给 g_eventLoop 管理的连接：业务代码直接用 sendToClient
+        - send_json_response 是旧的阻塞直写，遇到 EAGAIN 会截断，新代码不要再用
+    访问数据库
+        - GetUserDBExecutor / GetGameDBExecutor  EventLoop 上的业务查库走这里，DB 线程执行，
+                        结果通过 queueInLoop 回到 loop 线程；不要在 loop 线程里直接用 ConnectionPoolAgent
+        - GetPlayerStore().put(ToRow(...))  玩家状态写回：只标脏，后台线程合并后批量 upsert 到 gamedb
+        - GetUserStore / GetPlayerStorage  存储接口，GS_STORAGE=memory 时换成进程内实现
+        - OnlinePlayers::get(username)  登录时已并行装配好的玩家数据（角色/背包/任务/好友）
 
 
 3. 写事件全流程
@@ -0,0 +1,51 @@
+#include "AdminProc.h"
+#include "RecvProc.h"
+#include "HttpRouter.h"
+#include "ResponseSink.h"
+#include "EventLoop.h"
+#include "Client.h"
+#include "http_response.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <memory>
+using namespace std;
+
+extern EventLoop* g_eventLoop;
+
+static bool ProcHealthRequest(HttpRequest&, std::shared_ptr<Client> client)
+{
+    ResponseSink(g_eventLoop, client).sendJson(200, {{"status", "ok"}}, false);
+    return false; // 管理端口都是短连接
+}
+
+// Prometheus 文本格式
+static bool ProcMetricsRequest(HttpRequest&, std::shared_ptr<Client> client)
+{
+    string body = MetricsRegistry::getInstance().render();
+    string resp = HttpResponseBuilder(200).contentType(ContentType::TEXT).keepAlive(false).build(body);
+    ResponseSink(g_eventLoop, client).send(std::move(resp), false);
+    return false;
+}
+
+static const HttpRouter& AdminRouter()
+{
+    static const HttpRouter router = []() {
+        HttpRouter r;
+        r.addRoute(HttpMethod::GET, "/health",
+            [](HttpRequest& req, std::shared_ptr<Client> client, const RouteParams&) {
+                return ProcHealthRequest(req, client);
+            });
+        r.addRoute(HttpMethod::GET, "/metrics",
+            [](HttpRequest& req, std::shared_ptr<Client> client, const RouteParams&) {
+                return ProcMetricsRequest(req, client);
+            });
+        return r;
+    }();
+    return router;
+}
+
+int ProcAdminReq(int port)
+{
+    LOG_INFO("Starting admin listener on port %d", port);
+    return ServeHttp(port, AdminRouter());
+}
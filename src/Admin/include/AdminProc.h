@@ -0,0 +1,7 @@
+#ifndef ADMIN_PROC_H
+#define ADMIN_PROC_H
+
+// 单独起一个线程调用这个函数，监听运维/管理请求（健康检查等），与登录端口分开
+int ProcAdminReq(int port);
+
+#endif // ADMIN_PROC_H
@@ -3,6 +3,8 @@
 #include "Client.h"
 #include "LogM.h"
 #include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 EventLoop::EventLoop()
     : looping_(false),
@@ -52,6 +54,8 @@ void EventLoop::loop()
         for (auto& client : activeClients) {
             if (client->getFd() == wakeupFd_) {
                 handleRead(); // 处理wakeup事件
+            } else if (timers_.count(client->getFd())) {
+                handleTimer(client->getFd()); // 处理定时器事件
             } else {
                 handleClient(client); // 处理客户端事件
             }
@@ -74,13 +78,19 @@ void EventLoop::quit()
 
 void EventLoop::addClient(std::shared_ptr<Client> client)
 {
+    // 归属在调用线程就确定下来，之后其他线程的发送都会排到本 loop 的队列里，保证顺序
+    if (!client->claimOwnerLoop(this)) {
+        LOG_DEBUG("EventLoop::addClient fd=%d already owned by a loop", client->getFd());
+        return;
+    }
+
     if (isInLoopThread()) {
-        // 在EventLoop线程中直接添加
-        poller_->addClient(client, EPOLLIN | EPOLLPRI); // 监听读事件和优先级事件
+        // 在EventLoop线程中直接添加，默认监听读事件和优先级事件；已有待写数据时还会带上 EPOLLOUT
+        poller_->addClient(client, client->getEvents());
     } else {
         // 在其他线程中，加入队列等待处理
         runInLoop([this, client]() {
-            poller_->addClient(client, EPOLLIN | EPOLLPRI);
+            poller_->addClient(client, client->getEvents());
         });
     }
 }
@@ -88,14 +98,37 @@ void EventLoop::addClient(std::shared_ptr<Client> client)
 void EventLoop::removeClient(int fd)
 {
     if (isInLoopThread()) {
-        poller_->removeClient(fd);
+        removeClientInLoop(fd);
     } else {
         runInLoop([this, fd]() {
-            poller_->removeClient(fd);
+            removeClientInLoop(fd);
         });
     }
 }
 
+void EventLoop::removeClient(int fd, uint64_t connId)
+{
+    if (isInLoopThread()) {
+        removeClientInLoop(fd, connId);
+    } else {
+        runInLoop([this, fd, connId]() {
+            removeClientInLoop(fd, connId);
+        });
+    }
+}
+
+void EventLoop::removeClientInLoop(int fd, uint64_t connId)
+{
+    auto client = poller_->getClient(fd);
+    if (!client || (connId != 0 && client->getConnId() != connId)) {
+        return;
+    }
+    poller_->removeClient(fd);
+    client->handleClose();
+    // 未写完的数据不会再发出，通知等待方
+    client->firePendingWriteCallbacks(false);
+}
+
 void EventLoop::updateClient(std::shared_ptr<Client> client)
 {
     if (isInLoopThread()) {
@@ -138,6 +171,46 @@ void EventLoop::queueInLoop(Functor cb)
     }
 }
 
+void EventLoop::runEvery(std::chrono::milliseconds interval, Functor cb)
+{
+    runInLoop([this, interval, cb = std::move(cb)]() mutable {
+        runEveryInLoop(interval, std::move(cb));
+    });
+}
+
+void EventLoop::runEveryInLoop(std::chrono::milliseconds interval, Functor cb)
+{
+    int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("EventLoop::runEvery timerfd_create error, errno=%d", errno);
+        return;
+    }
+
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if (::timerfd_settime(fd, 0, &spec, nullptr) < 0) {
+        LOG_ERROR("EventLoop::runEvery timerfd_settime error, errno=%d", errno);
+        ::close(fd);
+        return;
+    }
+
+    timers_[fd] = std::move(cb);
+    poller_->addClient(std::make_shared<Client>(fd), EPOLLIN);
+}
+
+/* 处理定时器事件：读出超时次数清除事件，错过的多次超时只回调一次 */
+void EventLoop::handleTimer(int fd)
+{
+    uint64_t expirations = 0;
+    ssize_t n = ::read(fd, &expirations, sizeof(expirations));
+    if (n != sizeof(expirations)) {
+        return;
+    }
+    timers_[fd]();
+}
+
 /* 处理wakeup事件，读取eventfd以清除事件 */
 void EventLoop::handleRead()
 {
@@ -214,7 +287,8 @@ void EventLoop::handleClient(std::shared_ptr<Client> client)
     if (revents & EPOLLOUT) {
         if (client->hasDataToWrite()) {
             const std::string& buffer = client->getOutputBuffer();
-            ssize_t n = ::write(fd, buffer.data(), buffer.size());
+            // accept 出来的 fd 是阻塞的，这里用 MSG_DONTWAIT 保证不会卡住 loop 线程
+            ssize_t n = ::send(fd, buffer.data(), buffer.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
             
             if (n > 0) {
                 LOG_DEBUG("EventLoop wrote %ld bytes to fd=%d", n, fd);
@@ -224,6 +298,7 @@ void EventLoop::handleClient(std::shared_ptr<Client> client)
                 if (!client->hasDataToWrite()) {
                     client->disableWriting();
                     updateClient(client);
+                    client->firePendingWriteCallbacks(true);
                     client->handleWriteComplete();
                 }
             } else if (n == -1 && errno == EINTR) {
@@ -247,21 +322,37 @@ void EventLoop::handleClient(std::shared_ptr<Client> client)
 }
 
 // 便捷函数：发送数据到客户端
-void EventLoop::sendToClient(int fd, const std::string& data, 
+void EventLoop::sendToClient(int fd, std::string data, 
                               std::function<void()> writeCompleteCallback)
+{
+    std::function<void(bool)> done;
+    if (writeCompleteCallback) {
+        done = [cb = std::move(writeCompleteCallback)](bool ok) {
+            if (ok) cb();
+        };
+    }
+    sendToClientWithResult(fd, std::move(data), std::move(done));
+}
+
+void EventLoop::sendToClientWithResult(int fd, std::string data, std::function<void(bool ok)> done)
+{
+    sendToClientWithResult(fd, 0, std::move(data), std::move(done));
+}
+
+void EventLoop::sendToClientWithResult(int fd, uint64_t connId, std::string data, std::function<void(bool ok)> done)
 {
     if (isInLoopThread()) {
-        sendToClientInLoop(fd, data, std::move(writeCompleteCallback));
+        sendToClientInLoop(fd, connId, std::move(data), std::move(done));
         return;
     }
 
     // 跨线程调用：投递到 EventLoop 线程执行，不需要额外加锁
-    queueInLoop([this, fd, data, cb = std::move(writeCompleteCallback)]() mutable {
-        sendToClientInLoop(fd, data, std::move(cb));
+    queueInLoop([this, fd, connId, data = std::move(data), done = std::move(done)]() mutable {
+        sendToClientInLoop(fd, connId, std::move(data), std::move(done));
     });
 }
 
-void EventLoop::sendToClientInLoop(int fd, std::string data, std::function<void()> writeCompleteCallback)
+void EventLoop::sendToClientInLoop(int fd, uint64_t connId, std::string data, std::function<void(bool)> done)
 {
     if (!isInLoopThread()) {
         LOG_ERROR("EventLoop::sendToClientInLoop called from wrong thread, fd=%d", fd);
@@ -271,30 +362,61 @@ void EventLoop::sendToClientInLoop(int fd, std::string data, std::function<void(
     auto client = poller_->getClient(fd);
     if (!client) {
         LOG_ERROR("EventLoop::sendToClient - Client fd=%d not found", fd);
+        if (done) done(false);
         return;
     }
-
-    client->appendToOutputBuffer(data);
-    if (!client->isWriting()) {
-        client->enableWriting();
+    if (connId != 0 && client->getConnId() != connId) {
+        LOG_DEBUG("EventLoop::sendToClient - fd=%d now belongs to another connection, %zu bytes dropped",
+                  fd, data.size());
+        if (done) done(false);
+        return;
     }
 
-    if (writeCompleteCallback) {
-        client->setWriteCompleteCallback([cb = std::move(writeCompleteCallback)](Client*) mutable {
-            cb();
-        });
+    // 写缓冲为空时先尝试直接写，大多数响应一次就能写完，不必等下一轮 EPOLLOUT
+    size_t written = 0;
+    if (!client->hasDataToWrite()) {
+        while (written < data.size()) {
+            ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n > 0) {
+                written += static_cast<size_t>(n);
+                continue;
+            }
+            if (n == -1 && errno == EINTR) {
+                continue;
+            }
+            if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            LOG_ERROR("EventLoop::sendToClient write error for fd=%d, errno=%d", fd, errno);
+            if (done) done(false);
+            client->handleError();
+            removeClientInLoop(fd);
+            return;
+        }
+        if (written == data.size()) {
+            LOG_DEBUG("EventLoop::sendToClient - Wrote %zu bytes directly to fd=%d", data.size(), fd);
+            if (done) done(true);
+            return;
+        }
     }
 
-    updateClient(client);
+    client->appendToOutputBuffer(data.data() + written, data.size() - written);
+    if (done) {
+        client->addPendingWriteCallback(std::move(done));
+    }
+    if (!client->isWriting()) {
+        client->enableWriting();
+        updateClient(client);
+    }
 
-    LOG_DEBUG("EventLoop::sendToClient - Scheduled data (%zu bytes) for fd=%d", data.size(), fd);
+    LOG_DEBUG("EventLoop::sendToClient - Scheduled data (%zu bytes) for fd=%d", data.size() - written, fd);
 }
 
 // 便捷函数：发送数据后关闭连接
-void EventLoop::sendAndClose(int fd, const std::string& data)
+void EventLoop::sendAndClose(int fd, std::string data)
 {
-    sendToClient(fd, data, [this, fd]() {
-        LOG_INFO("EventLoop::sendAndClose - Data sent to fd=%d, closing connection", fd);
+    sendToClientWithResult(fd, std::move(data), [this, fd](bool ok) {
+        LOG_INFO("EventLoop::sendAndClose - Data %s to fd=%d, closing connection", ok ? "sent" : "dropped", fd);
         removeClient(fd);
     });
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+#include "ResponseSink.h"
+#include "EventLoop.h"
+#include "Client.h"
+#include "http_response.h"
+#include "LogM.h"
+#include <sys/socket.h>
+#include <errno.h>
+
+void ResponseSink::send(std::string data, bool keepAlive, CompleteCallback cb)
+{
+    int fd = client_->getFd();
+    uint64_t connId = client_->getConnId();
+
+    // keepAlive=false：不管成功与否，结束后都把连接从 loop 摘掉（引用计数归0时 Client 析构会 close）
+    // 按 connId 摘：回调可能在连接已被关掉、fd 被新连接复用之后才执行
+    auto finish = [cb = std::move(cb), keepAlive, fd, connId](EventLoop* loop, bool ok) {
+        if (cb) cb(ok);
+        if (!keepAlive && loop) {
+            loop->removeClient(fd, connId);
+        }
+    };
+
+    EventLoop* owner = client_->ownerLoop();
+    if (owner) {
+        owner->sendToClientWithResult(fd, connId, std::move(data), [finish, owner](bool ok) {
+            finish(owner, ok);
+        });
+        return;
+    }
+
+    // 还没交给 EventLoop：非阻塞直写，不修改 socket 的阻塞属性
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::send(fd, data.data() + written, data.size() - written, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        LOG_ERROR("ResponseSink write error for fd=%d, errno=%d", fd, errno);
+        finish(nullptr, false);
+        return;
+    }
+
+    if (written == data.size()) {
+        finish(nullptr, true);
+        return;
+    }
+
+    if (!loop_) {
+        LOG_ERROR("ResponseSink fd=%d would block and no EventLoop to continue, %zu bytes dropped",
+                  fd, data.size() - written);
+        finish(nullptr, false);
+        return;
+    }
+
+    // 慢对端：剩余数据挂到 Client 写缓冲，带着 EPOLLOUT 交给 loop 继续写
+    LOG_DEBUG("ResponseSink fd=%d handing %zu pending bytes to EventLoop", fd, data.size() - written);
+    client_->appendToOutputBuffer(data.data() + written, data.size() - written);
+    client_->enableWriting();
+    EventLoop* loop = loop_;
+    client_->addPendingWriteCallback([finish, loop](bool ok) {
+        finish(loop, ok);
+    });
+    loop_->addClient(client_);
+}
+
+void ResponseSink::sendJson(int statusCode, const nlohmann::json& body, bool keepAlive, CompleteCallback cb,
+                            const std::vector<std::pair<std::string, std::string>>& extraHeaders)
+{
+    HttpResponseBuilder builder(statusCode);
+    builder.contentType(ContentType::JSON).keepAlive(keepAlive);
+    for (const auto& kv : extraHeaders) {
+        builder.header(kv.first, kv.second);
+    }
+    send(builder.build(body.dump()), keepAlive, std::move(cb));
+}
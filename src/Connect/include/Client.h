@@ -2,18 +2,26 @@
 #define CLIENT_H
 
 #include <unistd.h> // for close()
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 #include <sys/epoll.h>
 
+class EventLoop;
+
 class Client {
 public:
     using ReadCallback = std::function<void(Client*, const char*, ssize_t)>;
     using WriteCompleteCallback = std::function<void(Client*)>;
     using ErrorCallback = std::function<void(Client*)>;
+    using CloseCallback = std::function<void(Client*)>; // 从 EventLoop 移除（断线、出错、主动关闭）时触发
+    using PendingWriteCallback = std::function<void(bool ok)>; // 一次性：本批数据写完(true)或连接失败(false)
 
     explicit Client(int fd) 
         : fd_(fd), 
+          connId_(nextConnId()),
           revents_(0),
           events_(EPOLLIN | EPOLLPRI) // 默认监听读事件
     {}
@@ -30,12 +38,16 @@ public:
     
     Client(Client&& other) noexcept 
         : fd_(other.fd_), 
+          connId_(other.connId_),
           revents_(other.revents_),
           events_(other.events_),
+          ownerLoop_(other.ownerLoop_.load()),
           outputBuffer_(std::move(other.outputBuffer_)),
+          pendingWriteCallbacks_(std::move(other.pendingWriteCallbacks_)),
           readCallback_(std::move(other.readCallback_)),
           writeCompleteCallback_(std::move(other.writeCompleteCallback_)),
-          errorCallback_(std::move(other.errorCallback_))
+          errorCallback_(std::move(other.errorCallback_)),
+          closeCallback_(std::move(other.closeCallback_))
     {
         other.fd_ = -1;
         other.revents_ = 0;
@@ -46,12 +58,16 @@ public:
         if (this != &other) {
             if (fd_ >= 0) close(fd_);
             fd_ = other.fd_;
+            connId_ = other.connId_;
             revents_ = other.revents_;
             events_ = other.events_;
+            ownerLoop_ = other.ownerLoop_.load();
             outputBuffer_ = std::move(other.outputBuffer_);
+            pendingWriteCallbacks_ = std::move(other.pendingWriteCallbacks_);
             readCallback_ = std::move(other.readCallback_);
             writeCompleteCallback_ = std::move(other.writeCompleteCallback_);
             errorCallback_ = std::move(other.errorCallback_);
+            closeCallback_ = std::move(other.closeCallback_);
             other.fd_ = -1;
             other.revents_ = 0;
             other.events_ = 0;
@@ -61,6 +77,15 @@ public:
     
     int getFd() const { return fd_; }
     bool isValid() const { return fd_ >= 0; }
+    // 进程内唯一的连接编号：fd 会被内核复用，跨线程引用某条连接时用 connId 校验
+    uint64_t getConnId() const { return connId_; }
+
+    // 所属 EventLoop：交给 EventLoop 之后，所有写操作都必须经由该 loop 的写缓冲
+    EventLoop* ownerLoop() const { return ownerLoop_.load(std::memory_order_acquire); }
+    bool claimOwnerLoop(EventLoop* loop) {
+        EventLoop* expected = nullptr;
+        return ownerLoop_.compare_exchange_strong(expected, loop, std::memory_order_acq_rel);
+    }
     
     // epoll事件相关
     void setRevents(uint32_t revents) { revents_ = revents; }
@@ -73,6 +98,7 @@ public:
     void setReadCallback(const ReadCallback& cb) { readCallback_ = cb; }
     void setWriteCompleteCallback(const WriteCompleteCallback& cb) { writeCompleteCallback_ = cb; }
     void setErrorCallback(const ErrorCallback& cb) { errorCallback_ = cb; }
+    void setCloseCallback(const CloseCallback& cb) { closeCallback_ = cb; }
     
     // 写缓冲区操作
     void appendToOutputBuffer(const std::string& data) { outputBuffer_.append(data); }
@@ -80,6 +106,14 @@ public:
     const std::string& getOutputBuffer() const { return outputBuffer_; }
     void clearOutputBuffer(size_t len) { outputBuffer_.erase(0, len); }
     bool hasDataToWrite() const { return !outputBuffer_.empty(); }
+
+    // 一次性写完成回调，写缓冲清空时以 true 触发，连接被移除时以 false 触发
+    void addPendingWriteCallback(PendingWriteCallback cb) { pendingWriteCallbacks_.push_back(std::move(cb)); }
+    void firePendingWriteCallbacks(bool ok) {
+        std::vector<PendingWriteCallback> cbs;
+        cbs.swap(pendingWriteCallbacks_);
+        for (auto& cb : cbs) cb(ok);
+    }
     
     // 启用/禁用写事件监听
     void enableWriting() { events_ |= EPOLLOUT; }
@@ -96,17 +130,29 @@ public:
     void handleError() {
         if (errorCallback_) errorCallback_(this);
     }
+    void handleClose() {
+        if (closeCallback_) closeCallback_(this);
+    }
     
 private:
+    static uint64_t nextConnId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
     int fd_;
+    uint64_t connId_;
     uint32_t revents_; // epoll返回的活动事件
     uint32_t events_;  // 当前监听的事件
+    std::atomic<EventLoop*> ownerLoop_{nullptr};
     
     std::string outputBuffer_; // 写缓冲区
+    std::vector<PendingWriteCallback> pendingWriteCallbacks_;
     
     ReadCallback readCallback_;
     WriteCompleteCallback writeCompleteCallback_;
     ErrorCallback errorCallback_;
+    CloseCallback closeCallback_;
 };
 
 #endif
\ No newline at end of file
@@ -1,11 +1,14 @@
 #ifndef EVENTLOOP_H
 #define EVENTLOOP_H
 
+#include <chrono>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <functional>
 #include <mutex>
 #include <atomic>
+#include <cstdint>
 #include <thread>
 #include <sys/epoll.h>
 
@@ -24,24 +27,33 @@ public:
     void loop();
     void quit();
 
-    // 线程安全的方式添加连接到EventLoop  
+    // 线程安全的方式添加连接到EventLoop（已归属某个 loop 的连接会被忽略）
     void addClient(std::shared_ptr<Client> client);
     void removeClient(int fd);
+    // 只在 fd 上仍是 connId 这条连接时才移除：跨线程延后执行时 fd 可能已被内核复用给新连接
+    void removeClient(int fd, uint64_t connId);
     void updateClient(std::shared_ptr<Client> client); // 更新客户端监听的事件
     // 获取指定fd的Client（仅限 EventLoop 线程内调用；跨线程请用 runInLoop/queueInLoop）
     std::shared_ptr<Client> getClient(int fd);
 
-    // 便捷函数：发送数据到客户端
-    void sendToClient(int fd, const std::string& data, 
+    // 便捷函数：发送数据到客户端，回调只在数据全部写出后触发一次
+    void sendToClient(int fd, std::string data, 
                      std::function<void()> writeCompleteCallback = nullptr);
+    // 同上，但连接在写完前被移除时也会以 ok=false 回调
+    void sendToClientWithResult(int fd, std::string data, std::function<void(bool ok)> done);
+    // 同上，执行时 fd 上已不是 connId 这条连接（断开后 fd 被复用）就丢弃数据、以 ok=false 回调
+    void sendToClientWithResult(int fd, uint64_t connId, std::string data, std::function<void(bool ok)> done);
     
     // 便捷函数：发送数据后关闭连接
-    void sendAndClose(int fd, const std::string& data);
+    void sendAndClose(int fd, std::string data);
 
     // 在EventLoop线程中执行函数
     void runInLoop(Functor cb);
     void queueInLoop(Functor cb);
 
+    // 周期定时器（timerfd），回调在 EventLoop 线程里执行；可以跨线程调用
+    void runEvery(std::chrono::milliseconds interval, Functor cb);
+
     bool isInLoopThread() const { return threadId_ == std::this_thread::get_id(); }
 
 private:
@@ -50,7 +62,10 @@ private:
     void wakeup();
     void handleClient(std::shared_ptr<Client> client); // 处理客户端事件
 
-    void sendToClientInLoop(int fd, std::string data, std::function<void()> writeCompleteCallback);
+    void sendToClientInLoop(int fd, uint64_t connId, std::string data, std::function<void(bool)> done); // connId=0 不校验
+    void removeClientInLoop(int fd, uint64_t connId = 0); // connId=0 不校验
+    void runEveryInLoop(std::chrono::milliseconds interval, Functor cb);
+    void handleTimer(int fd);
 
     std::atomic<bool> looping_;
     std::atomic<bool> quit_;
@@ -61,6 +76,9 @@ private:
     int wakeupFd_;
     std::shared_ptr<Client> wakeupClient_;
 
+    // timerfd -> 回调，只在 EventLoop 线程访问；fd 由注册到 poller 的 Client 持有并关闭
+    std::unordered_map<int, Functor> timers_;
+
     // 跨线程调用
     mutable std::mutex mutex_;
     std::vector<Functor> pendingFunctors_;
@@ -0,0 +1,38 @@
+#ifndef RESPONSE_SINK_H
+#define RESPONSE_SINK_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "json.hpp"
+
+class Client;
+class EventLoop;
+
+/*
+    统一的响应出口，替代 send_json_response 的阻塞直写：
+    - 连接已归属某个 EventLoop：投递到该 loop 的写缓冲，保证与之前的数据有序
+    - 连接还在工作线程（handle_client）：先用 MSG_DONTWAIT 直接写，
+      写不完（EAGAIN）就把剩余数据放进 Client 写缓冲并交给 loop，由 EPOLLOUT 续写
+    任何情况下都不会阻塞调用线程；keepAlive=false 时写完（或失败）后关闭连接
+*/
+class ResponseSink {
+public:
+    using CompleteCallback = std::function<void(bool ok)>;
+
+    ResponseSink(EventLoop* loop, std::shared_ptr<Client> client)
+        : loop_(loop), client_(std::move(client)) {}
+
+    void send(std::string data, bool keepAlive, CompleteCallback cb = nullptr);
+
+    void sendJson(int statusCode, const nlohmann::json& body, bool keepAlive, CompleteCallback cb = nullptr,
+                  const std::vector<std::pair<std::string, std::string>>& extraHeaders = {});
+
+private:
+    EventLoop* loop_;
+    std::shared_ptr<Client> client_;
+};
+
+#endif // RESPONSE_SINK_H
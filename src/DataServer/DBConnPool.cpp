@@ -1,5 +1,8 @@
 #include "DBConnPool.h"
 #include "LogM.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
@@ -16,77 +19,198 @@ DBConnPool& GetGameDBPool(DBConnInfo info)
 }
 
 DBConnPool::DBConnPool(const std::string &host, const std::string &user, const std::string &password,
-    const std::string &database, int maxConnections, int minConnections)
+    const std::string &database, int maxConnections, int minConnections, const std::string &metricName)
     : host_(host), user_(user), password_(password), database_(database),
       maxConnections_(maxConnections), minConnections_(minConnections),
       currentConnections_(0), isRunning_(true)
 {
     driver_ = sql::mysql::get_mysql_driver_instance();
 
+    auto& registry = MetricsRegistry::getInstance();
+    std::string prefix = "db_" + (metricName.empty() ? database_ : metricName);
+    checkoutHist_ = &registry.histogram(prefix + "_checkout_us", "Time to check out a connection from the " + database_ + " pool");
+    returnHist_ = &registry.histogram(prefix + "_return_us", "Time to return a connection to the " + database_ + " pool");
+    validateHist_ = &registry.histogram(prefix + "_validate_us", "SELECT 1 round trips on idle " + database_ + " connections");
+    waitHist_ = &registry.histogram(prefix + "_checkout_wait_us", "Time spent queued for an exhausted " + database_ + " pool");
+    waitersGauge_ = &registry.gauge(prefix + "_checkout_waiters", "Threads queued for a " + database_ + " connection");
+    timeoutCounter_ = &registry.counter(prefix + "_checkout_timeout_total", "Checkouts from the " + database_ + " pool that hit their deadline");
+
+    auto now = SteadyClock::now();
     for (int i = 0; i < minConnections_; ++i) {
         try {
             auto conn = createConnection();
-            connections_.push(conn);
+            connections_.push_back({std::make_shared<PooledConnection>(conn), now});
             ++currentConnections_;
         } catch (const sql::SQLException& e) {
             LOG_ERROR("Failed to create initial connection: %s, code: %d", e.what(), e.getErrorCode());
         }
     }
+
+    keepaliveThread_ = std::thread([this]() { keepaliveLoop(); });
 }
 
 DBConnPool::~DBConnPool()
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (!isRunning_) return;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!isRunning_) return;
+
+        isRunning_ = false;
+        // 清空队列，shared_ptr 离开作用域会自动析构连接
+        connections_.clear();
 
-    isRunning_ = false;
-    // 清空队列，shared_ptr 离开作用域会自动析构连接
-    while (!connections_.empty()) {
-        connections_.pop();
+        // 唤醒所有排队的线程，让它们返回 nullptr
+        for (Waiter* w : waiters_) {
+            w->cv.notify_one();
+        }
+        waiters_.clear();
+        waitersGauge_->set(0);
+        stopCv_.notify_all();
+    }
+    if (keepaliveThread_.joinable()) {
+        keepaliveThread_.join();
     }
+}
 
-    // 唤醒所有等待中的线程，让它们返回 nullptr
-    condVar_.notify_all();
+PooledConnPtr DBConnPool::getConnection(std::chrono::milliseconds timeout, CheckoutStatus* status)
+{
+    auto start = SteadyClock::now();
+    CheckoutStatus st = CheckoutStatus::OK;
+    auto conn = acquireConnection(timeout, st);
+    checkoutHist_->observe(SteadyClock::now() - start);
+    if (status) *status = st;
+    return conn;
 }
 
-std::shared_ptr<sql::Connection> DBConnPool::getConnection()
+PooledConnPtr DBConnPool::acquireConnection(std::chrono::milliseconds timeout, CheckoutStatus& status)
 {
+    auto deadline = SteadyClock::now() + timeout;
+    IdleConn idle;
     {
         unique_lock<std::mutex> lock(mutex_);
-        if (!connections_.empty()) {
-            auto conn = connections_.front();
-            connections_.pop();
-            return conn;
+        if (!isRunning_) {
+            status = CheckoutStatus::SHUTDOWN;
+            return nullptr;
         }
 
-        if (currentConnections_ < maxConnections_) {
-            ++currentConnections_;
+        // 有人在排队时不插队，即使此刻恰好有空闲连接
+        if (waiters_.empty() && !connections_.empty()) {
+            idle = std::move(connections_.back());
+            connections_.pop_back();
+        } else if (waiters_.empty() && currentConnections_ < maxConnections_) {
+            ++currentConnections_; // 先占名额，锁外建连接
         } else {
-            condVar_.wait(lock, [this]() {
-                return !isRunning_ || !connections_.empty();
+            Waiter self;
+            waiters_.push_back(&self);
+            waitersGauge_->set(static_cast<int64_t>(waiters_.size()));
+            auto waitStart = SteadyClock::now();
+            bool served = self.cv.wait_until(lock, deadline, [this, &self]() {
+                return !isRunning_ || self.conn || self.slotGranted;
             });
-            if (!isRunning_) return nullptr;
+            waitHist_->observe(SteadyClock::now() - waitStart);
+
+            if (self.conn) {
+                status = CheckoutStatus::OK;
+                return self.conn; // 刚被归还的连接，不需要再校验
+            }
+            if (!served) {
+                // 超时时还在队列里（交付方会先把等待者出队），自己摘掉
+                waiters_.erase(std::find(waiters_.begin(), waiters_.end(), &self));
+                waitersGauge_->set(static_cast<int64_t>(waiters_.size()));
+                timeoutCounter_->inc();
+                status = CheckoutStatus::TIMEOUT;
+                return nullptr;
+            }
+            if (!self.slotGranted) {
+                status = CheckoutStatus::SHUTDOWN;
+                return nullptr;
+            }
+            // 拿到的是名额，下面锁外新建连接
+        }
+    }
 
-            auto conn = connections_.front();
-            connections_.pop();
-            return conn;
+    // 刚用过的连接直接借出；空闲太久的才在锁外 ping 一次
+    if (idle.conn) {
+        if (SteadyClock::now() - idle.lastUsed < kValidateAfterIdle || isConnectionValid(idle.conn->conn)) {
+            status = CheckoutStatus::OK;
+            return idle.conn;
         }
+        // 坏连接占的名额留给自己，直接新建一个替换，不用重新排队
+        LOG_INFO("Idle connection to %s is dead, replacing it", database_.c_str());
     }
 
     // 在锁外做可能很慢的 IO 操作
     try {
         shared_ptr<sql::Connection> newConn;
         newConn = createConnection(); // 调用驱动 / 连接数据库等
-        return newConn;
+        status = CheckoutStatus::OK;
+        return std::make_shared<PooledConnection>(newConn);
     } catch (const sql::SQLException& e) {
         LOG_ERROR("Failed to create connection: %s, code: %d", e.what(), e.getErrorCode());
-        std::unique_lock<std::mutex> lock(mutex_);
+        discardConnection(); // 创建失败，要把刚才占掉的“名额”还回去
+        status = CheckoutStatus::CONNECT_FAILED;
+        return nullptr;
+    }
+}
+
+void DBConnPool::discardConnection()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    releaseSlotLocked();
+}
+
+void DBConnPool::handOffLocked(PooledConnPtr conn, SteadyClock::time_point now)
+{
+    if (waiters_.empty()) {
+        connections_.push_back({std::move(conn), now});
+        return;
+    }
+    Waiter* w = waiters_.front();
+    waiters_.pop_front();
+    waitersGauge_->set(static_cast<int64_t>(waiters_.size()));
+    w->conn = std::move(conn);
+    w->cv.notify_one();
+}
+
+void DBConnPool::releaseSlotLocked()
+{
+    if (!isRunning_ || waiters_.empty()) {
         if (currentConnections_ > 0) {
-            --currentConnections_; // 创建失败，要把刚才占掉的“名额”还回去
+            --currentConnections_;
         }
-        condVar_.notify_all(); // 唤醒一下可能在等的线程
-        return nullptr;
+        return;
+    }
+    // 名额直接转给队首，计数不变，由它去新建连接
+    Waiter* w = waiters_.front();
+    waiters_.pop_front();
+    waitersGauge_->set(static_cast<int64_t>(waiters_.size()));
+    w->slotGranted = true;
+    w->cv.notify_one();
+}
+
+sql::PreparedStatement* StatementCache::get(sql::Connection* conn, const std::string& sqlText)
+{
+    static auto& hits = MetricsRegistry::getInstance().counter(
+        "db_stmt_cache_hit_total", "Prepared statements reused from the per-connection cache");
+    static auto& misses = MetricsRegistry::getInstance().counter(
+        "db_stmt_cache_miss_total", "Prepared statements created on a connection");
+
+    auto it = stmts_.find(sqlText);
+    if (it != stmts_.end()) {
+        hits.inc();
+        return it->second.get();
     }
+
+    misses.inc();
+    if (stmts_.size() >= kMaxStatements) {
+        LOG_ERROR("StatementCache full (%zu), clearing; check for SQL built by string concatenation", stmts_.size());
+        stmts_.clear();
+    }
+    // prepare 失败会抛 SQLException，此时不会留下缓存项
+    std::unique_ptr<sql::PreparedStatement> stmt(conn->prepareStatement(sqlText));
+    sql::PreparedStatement* raw = stmt.get();
+    stmts_.emplace(sqlText, std::move(stmt));
+    return raw;
 }
 
 shared_ptr<sql::Connection> DBConnPool::createConnection()
@@ -110,24 +234,95 @@ shared_ptr<sql::Connection> DBConnPool::createConnection()
     }
 }
 
-void DBConnPool::returnConnection(std::shared_ptr<sql::Connection> conn)
+void DBConnPool::returnConnection(PooledConnPtr conn)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (!isRunning_) {
-        // 池已经关闭了，直接丢弃连接并减少计数
-        currentConnections_--;
-        return;
+    auto start = SteadyClock::now();
+    // isClosed 只看驱动本地状态，不走网络；真正的探活留给借出时和 keepalive
+    bool closed = true;
+    try {
+        closed = !conn || conn->conn->isClosed();
+    } catch (const sql::SQLException& e) {
+        LOG_INFO("Connection state check failed: %s, code: %d", e.what(), e.getErrorCode());
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!isRunning_ || closed) {
+            // 池已经关闭或连接已断开，直接丢弃连接，名额交给排队者或减少计数
+            releaseSlotLocked();
+            if (closed && isRunning_) {
+                LOG_INFO("Returned connection is closed, discarding. Current connections: %d", currentConnections_);
+            }
+        } else {
+            handOffLocked(std::move(conn), start);
+        }
     }
-    if (isConnectionValid(conn)) {
-        connections_.push(conn);
-        condVar_.notify_one();
-    } else {
-        currentConnections_--;
-        LOG_INFO("Returned connection is invalid, discarding. Current connections: %d", currentConnections_);
+    returnHist_->observe(SteadyClock::now() - start);
+}
+
+void DBConnPool::keepaliveLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (isRunning_) {
+        stopCv_.wait_for(lock, kKeepaliveInterval, [this]() { return !isRunning_; });
+        if (!isRunning_) break;
+
+        // 1. 取出空闲超过阈值的连接（队头最旧），它们仍计入 currentConnections_
+        auto now = SteadyClock::now();
+        std::vector<PooledConnPtr> idle;
+        while (!connections_.empty() && now - connections_.front().lastUsed >= kValidateAfterIdle) {
+            idle.push_back(std::move(connections_.front().conn));
+            connections_.pop_front();
+        }
+        int deficit = std::max(0, minConnections_ - currentConnections_);
+        currentConnections_ += deficit;
+        lock.unlock();
+
+        // 2. 锁外 ping / 补建连接
+        std::vector<PooledConnPtr> alive;
+        for (auto& conn : idle) {
+            if (isConnectionValid(conn->conn)) {
+                alive.push_back(std::move(conn));
+            }
+        }
+        int dead = static_cast<int>(idle.size() - alive.size());
+        for (int i = 0; i < deficit; ++i) {
+            try {
+                alive.push_back(std::make_shared<PooledConnection>(createConnection()));
+            } catch (const sql::SQLException&) {
+                ++dead; // createConnection 已经记过日志
+            }
+        }
+
+        // 3. 先满足排队者，其余放回队尾，刚 ping 过的视为刚用过
+        lock.lock();
+        if (isRunning_) {
+            for (int i = 0; i < dead; ++i) {
+                releaseSlotLocked();
+            }
+            auto pinged = SteadyClock::now();
+            for (auto& conn : alive) {
+                handOffLocked(std::move(conn), pinged);
+            }
+        } else {
+            currentConnections_ = std::max(0, currentConnections_ - dead - static_cast<int>(alive.size()));
+        }
+        if (dead > 0) {
+            LOG_INFO("Keepalive on %s dropped %d connections, current connections: %d",
+                     database_.c_str(), dead, currentConnections_);
+        }
     }
 }
 
 bool DBConnPool::isConnectionValid(std::shared_ptr<sql::Connection> conn)
+{
+    auto start = SteadyClock::now();
+    bool valid = pingConnection(conn);
+    validateHist_->observe(SteadyClock::now() - start);
+    return valid;
+}
+
+bool DBConnPool::pingConnection(const std::shared_ptr<sql::Connection>& conn)
 {
     if (!conn) return false;
     
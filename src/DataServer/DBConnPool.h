@@ -4,7 +4,7 @@
 #include <string>
 #include <memory>
 #include <iostream>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -15,6 +15,12 @@
 #include <cppconn/exception.h>
 #include <cppconn/resultset.h>
 #include <memory>
+#include <unordered_map>
+
+class LatencyHistogram;
+class MetricCounter;
+class MetricGauge;
+
 enum class UserRole {
     User = 0,
     Admin = 1
@@ -36,55 +42,131 @@ struct UserInfo {
     UserRole role = UserRole::User;
 };
 
+/*
+    单个连接上的预编译语句缓存，按 SQL 文本索引：
+    同一条 SQL 在这个连接上只 prepare 一次，之后直接复用，省掉每次查询前的 prepare 往返
+    缓存跟着连接在池里流转，连接被丢弃时一起析构（先于连接本身）
+*/
+class StatementCache {
+public:
+    static constexpr size_t kMaxStatements = 64; // 防止拼接 SQL 误用导致服务端语句数无限增长
+
+    // 返回的语句归缓存所有，调用方不要 delete；每次使用前需重新 set 全部参数
+    sql::PreparedStatement* get(sql::Connection* conn, const std::string& sqlText);
+    void erase(const std::string& sqlText) { stmts_.erase(sqlText); }
+    size_t size() const { return stmts_.size(); }
+
+private:
+    std::unordered_map<std::string, std::unique_ptr<sql::PreparedStatement>> stmts_;
+};
+
+struct PooledConnection {
+    explicit PooledConnection(std::shared_ptr<sql::Connection> c) : conn(std::move(c)) {}
+
+    std::shared_ptr<sql::Connection> conn; // 声明在前，析构在后：语句先于连接释放
+    StatementCache stmts;
+};
+using PooledConnPtr = std::shared_ptr<PooledConnection>;
+
+enum class CheckoutStatus {
+    OK,
+    TIMEOUT,        // 池已耗尽且在期限内没等到连接，调用方应回 503
+    SHUTDOWN,       // 池已关闭
+    CONNECT_FAILED  // 有名额但新建连接失败
+};
+
+/*
+    MySQL 连接池：
+    - 归还时不再 ping，只检查本地的 isClosed；借出时空闲超过 kValidateAfterIdle 的连接才在锁外 SELECT 1
+    - 后台 keepalive 线程每 kKeepaliveInterval 把久未使用的空闲连接取出来 ping 一遍，
+      坏的丢掉，并把连接数补回 minConnections
+    - 借出/归还/校验耗时记在 db_<库名>_checkout_us / _return_us / _validate_us 直方图里
+    - 池耗尽时按 FIFO 排队，归还的连接和空出的名额都直接交给队首；等待带期限，
+      超时返回 TIMEOUT 而不是无限阻塞。排队耗时 db_<库名>_checkout_wait_us，
+      当前排队人数 db_<库名>_checkout_waiters，超时次数 db_<库名>_checkout_timeout_total
+*/
 class DBConnPool {
 public:
+    static constexpr std::chrono::seconds kValidateAfterIdle{30};
+    static constexpr std::chrono::seconds kKeepaliveInterval{30};
+    static constexpr std::chrono::milliseconds kDefaultCheckoutTimeout{1000};
+
+    // metricName 是 /metrics 里的库名（db_<metricName>_...），为空时用 database；同一个库开多个池（分片）时要区分
     DBConnPool(const std::string& host, const std::string& user, const std::string& password,
-        const std::string& database, int maxConnections = 10, int minConnections = 2);
+        const std::string& database, int maxConnections = 10, int minConnections = 2,
+        const std::string& metricName = "");
     ~DBConnPool();
     DBConnPool(const DBConnPool&) = delete;
     DBConnPool& operator=(const DBConnPool&) = delete;
 
-    // 从池中获取一个连接（shared_ptr）
-    std::shared_ptr<sql::Connection> getConnection();
+    // 从池中获取一个连接（连同它的语句缓存），失败返回 nullptr，原因见 status
+    PooledConnPtr getConnection(std::chrono::milliseconds timeout = kDefaultCheckoutTimeout,
+                                CheckoutStatus* status = nullptr);
 
     // 归还连接
-    void returnConnection(std::shared_ptr<sql::Connection> conn);
+    void returnConnection(PooledConnPtr conn);
 private:
+    using SteadyClock = std::chrono::steady_clock;
+
+    struct IdleConn {
+        PooledConnPtr conn;
+        SteadyClock::time_point lastUsed;
+    };
+
+    // 排队借连接的线程，对象在等待者自己的栈上
+    struct Waiter {
+        std::condition_variable cv;
+        PooledConnPtr conn;       // 交付的是一个刚归还的连接
+        bool slotGranted = false; // 交付的是一个新建连接的名额
+    };
+
     std::string host_;
     std::string user_;
     std::string password_;
     std::string database_;
 
-    bool isRunning_;
     int maxConnections_;
     int minConnections_;
-    int currentConnections_;
+    int currentConnections_; // 已借出 + 空闲 + 正在新建的连接数，只在 mutex_ 下修改
+    bool isRunning_;
 
-    std::queue<std::shared_ptr<sql::Connection>> connections_;
+    // 队尾是最近归还的连接，优先借出；队头最久未用，由 keepalive 检查
+    std::deque<IdleConn> connections_;
+    std::deque<Waiter*> waiters_;
     std::mutex mutex_;
-    std::condition_variable condVar_;
+    std::condition_variable stopCv_; // 只用来唤醒 keepalive 线程退出
+    std::thread keepaliveThread_;
 
     sql::Driver* driver_{nullptr};
 
-    std::shared_ptr<sql::Connection> createConnection(); // 创建新连接
+    LatencyHistogram* checkoutHist_;
+    LatencyHistogram* returnHist_;
+    LatencyHistogram* validateHist_;
+    LatencyHistogram* waitHist_;
+    MetricGauge* waitersGauge_;
+    MetricCounter* timeoutCounter_;
 
-    bool isConnectionValid(std::shared_ptr<sql::Connection> conn); // 验证连接是否有效
+    std::shared_ptr<sql::Connection> createConnection(); // 创建新连接
+    PooledConnPtr acquireConnection(std::chrono::milliseconds timeout, CheckoutStatus& status);
+    void discardConnection(); // 丢弃一个已借出的连接，归还名额
+    // 以下需持有 mutex_：把连接/名额交给队首等待者，没有等待者时放回空闲队列/减少计数
+    void handOffLocked(PooledConnPtr conn, SteadyClock::time_point now);
+    void releaseSlotLocked();
+    void keepaliveLoop();
+
+    bool isConnectionValid(std::shared_ptr<sql::Connection> conn); // 验证连接是否有效（记录耗时）
+    bool pingConnection(const std::shared_ptr<sql::Connection>& conn); // SELECT 1
 };
 
+// 借一个连接，析构时归还；拿不到时 operator bool 为 false，status() 说明原因（TIMEOUT 应回 503）
 class ConnectionPoolAgent {
 public:
     explicit ConnectionPoolAgent(DBConnPool* pool,
-                                 int retryIntervalMs = 10)
+                                 std::chrono::milliseconds timeout = DBConnPool::kDefaultCheckoutTimeout)
         : pool_(pool)
     {
-        while (pool_) {
-            conn_ = pool_->getConnection();
-            if (conn_) break;
-
-            // 没拿到就睡一会再试，避免空转占满CPU
-            std::this_thread::sleep_for(
-                std::chrono::milliseconds(retryIntervalMs)
-            );
+        if (pool_) {
+            conn_ = pool_->getConnection(timeout, &status_);
         }
     }
 
@@ -94,15 +176,26 @@ public:
         }
     }
 
-    sql::Connection* operator->() { return conn_.get(); }
+    ConnectionPoolAgent(const ConnectionPoolAgent&) = delete;
+    ConnectionPoolAgent& operator=(const ConnectionPoolAgent&) = delete;
+
+    CheckoutStatus status() const { return status_; }
+    sql::Connection* operator->() { return conn_->conn.get(); }
     explicit operator bool() const { return conn_ != nullptr; }
 
+    // 走连接上的语句缓存；一次性的 SQL 直接用 ->prepareStatement
+    sql::PreparedStatement* prepare(const std::string& sqlText) {
+        return conn_->stmts.get(conn_->conn.get(), sqlText);
+    }
+
 private:
     DBConnPool* pool_;
-    std::shared_ptr<sql::Connection> conn_;
+    PooledConnPtr conn_;
+    CheckoutStatus status_ = CheckoutStatus::SHUTDOWN;
 };
 
 
 DBConnPool& GetUserDBPool(DBConnInfo info = {});
+// gamedb 分片后这里是 0 号分片的主库（GetGameDBRouter 建路由时用它）；按玩家读写请用 GetGameDBRouter().primary(username)
 DBConnPool& GetGameDBPool(DBConnInfo info = {});
 #endif // CONNECTION_POOL_H
@@ -0,0 +1,112 @@
+#include "DBExecutor.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+static size_t DBExecutorThreads()
+{
+    const char* env = getenv("GS_DB_THREADS");
+    size_t n = env ? static_cast<size_t>(strtoul(env, nullptr, 10)) : 0;
+    return n > 0 ? n : 4;
+}
+
+DBExecutor& GetUserDBExecutor()
+{
+    static DBExecutor executor(GetUserDBPool(), "userdb", DBExecutorThreads(), DBExecutorThreads() * 256);
+    return executor;
+}
+
+DBExecutor& GetGameDBExecutor()
+{
+    static DBExecutor executor(GetGameDBPool(), "gamedb", DBExecutorThreads(), DBExecutorThreads() * 256);
+    return executor;
+}
+
+DBExecutor& GetMemoryDBExecutor()
+{
+    static DBExecutor executor("memdb", DBExecutorThreads(), DBExecutorThreads() * 256);
+    return executor;
+}
+
+DBExecutor::DBExecutor(DBConnPool& pool, const string& name, size_t threads, size_t queueCapacity)
+    : pool_(&pool), name_(name), queueCapacity_(max<size_t>(1, queueCapacity))
+{
+    start(threads);
+}
+
+DBExecutor::DBExecutor(const string& name, size_t threads, size_t queueCapacity)
+    : pool_(nullptr), name_(name), queueCapacity_(max<size_t>(1, queueCapacity))
+{
+    start(threads);
+}
+
+void DBExecutor::start(size_t threads)
+{
+    auto& registry = MetricsRegistry::getInstance();
+    string prefix = "db_executor_" + name_;
+    rejected_ = &registry.counter(prefix + "_rejected_total", "DB jobs rejected because the " + name_ + " executor queue was full");
+    depth_ = &registry.gauge(prefix + "_queue_depth", "DB jobs waiting for a " + name_ + " executor thread");
+    queueWait_ = &registry.histogram(prefix + "_queue_wait_us", "Time DB jobs spent queued on the " + name_ + " executor");
+    runTime_ = &registry.histogram(prefix + "_run_us", "Time DB jobs spent running on the " + name_ + " executor");
+
+    threads = max<size_t>(1, threads);
+    LOG_INFO("DBExecutor %s threads=%zu queueCapacity=%zu", name_.c_str(), threads, queueCapacity_);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+DBExecutor::~DBExecutor()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+bool DBExecutor::enqueue(Job job)
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        if (stopping_ || jobs_.size() >= queueCapacity_) {
+            rejected_->inc();
+            return false;
+        }
+        jobs_.push_back({std::move(job), chrono::steady_clock::now()});
+        depth_->set(static_cast<int64_t>(jobs_.size()));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void DBExecutor::workerLoop()
+{
+    while (true) {
+        QueuedJob queued;
+        {
+            unique_lock<mutex> lk(mu_);
+            cv_.wait(lk, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_ && jobs_.empty()) return;
+            queued = std::move(jobs_.front());
+            jobs_.pop_front();
+            depth_->set(static_cast<int64_t>(jobs_.size()));
+        }
+
+        auto start = chrono::steady_clock::now();
+        queueWait_->observe(start - queued.enqueuedAt);
+        try {
+            queued.job();
+        } catch (const exception& e) {
+            LOG_ERROR("DBExecutor %s job failed: %s", name_.c_str(), e.what());
+        }
+        runTime_->observe(chrono::steady_clock::now() - start);
+    }
+}
@@ -0,0 +1,188 @@
+#ifndef DB_EXECUTOR_H
+#define DB_EXECUTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DBConnPool.h"
+#include "EventLoop.h"
+
+class MetricCounter;
+class MetricGauge;
+class LatencyHistogram;
+
+template <typename R>
+struct DBResult {
+    bool ok = false;
+    bool busy = false; // 借连接超时，调用方应回 503
+    R value{};
+    std::string error; // ok=false 时为异常信息
+};
+
+// 执行器队列已满或借连接超时：返回 future 的 submit 以这个异常结束，调用方应回 503
+class DBBusyError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/*
+    异步 DB 执行器：专用线程从 DBConnPool 借连接执行查询，EventLoop 线程不再被数据库阻塞
+        GetGameDBExecutor().submit<int64_t>(g_eventLoop,
+            [id](ConnectionPoolAgent& db) { ...查询...; return gold; },
+            [](DBResult<int64_t> r) { ...在 loop 线程里处理结果... });
+    - work 在 DB 线程执行，抛出的异常被捕获并以 ok=false 交给回调
+    - done 通过 loop->queueInLoop 投递回调用方的 loop；loop 为空时直接在 DB 线程回调
+    - 不在 loop 上的调用方（登录线程等）可以用返回 future 的重载
+    - 队列有上限，满了 submit 返回 false，调用方应回 503 而不是无限堆积；
+      借连接超时时 busy=true，同样应回 503
+    - R 不能是 void，只关心成败的写操作可以返回影响行数
+    - 不带连接池构造的执行器只接 post（不借连接的任务，例如内存存储），submit 一律以"no database connection"失败
+*/
+class DBExecutor {
+public:
+    using Job = std::function<void()>;
+
+    DBExecutor(DBConnPool& pool, const std::string& name, size_t threads, size_t queueCapacity);
+    DBExecutor(const std::string& name, size_t threads, size_t queueCapacity);
+    ~DBExecutor();
+    DBExecutor(const DBExecutor&) = delete;
+    DBExecutor& operator=(const DBExecutor&) = delete;
+
+    template <typename R>
+    bool submit(EventLoop* loop,
+                std::function<R(ConnectionPoolAgent&)> work,
+                std::function<void(DBResult<R>)> done)
+    {
+        return enqueue([this, loop, work = std::move(work), done = std::move(done)]() mutable {
+            auto result = std::make_shared<DBResult<R>>(run(work));
+            if (!done) return;
+            if (loop) {
+                loop->queueInLoop([done = std::move(done), result]() { done(std::move(*result)); });
+            } else {
+                done(std::move(*result));
+            }
+        });
+    }
+
+    // 失败时 future 里是异常；队列满或借连接超时时是 DBBusyError
+    template <typename R>
+    std::future<R> submit(std::function<R(ConnectionPoolAgent&)> work)
+    {
+        if (!pool_) {
+            std::promise<R> promise;
+            promise.set_exception(std::make_exception_ptr(std::runtime_error("no database connection")));
+            return promise.get_future();
+        }
+        return submit<R>(*pool_, std::move(work));
+    }
+
+    // 指定连接池（例如分片路由选出的库），仍在本执行器的线程上执行
+    template <typename R>
+    std::future<R> submit(DBConnPool& pool, std::function<R(ConnectionPoolAgent&)> work)
+    {
+        auto promise = std::make_shared<std::promise<R>>();
+        std::future<R> future = promise->get_future();
+        bool queued = enqueue([&pool, promise, work = std::move(work)]() {
+            try {
+                ConnectionPoolAgent agent(&pool);
+                if (!agent) {
+                    if (agent.status() == CheckoutStatus::TIMEOUT) throw DBBusyError("database busy");
+                    throw std::runtime_error("no database connection");
+                }
+                promise->set_value(work(agent));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        if (!queued) {
+            promise->set_exception(std::make_exception_ptr(DBBusyError("db executor overloaded")));
+        }
+        return future;
+    }
+
+    // 不借连接，直接在执行器线程上跑 work；队列满时 future 里是 DBBusyError
+    template <typename R>
+    std::future<R> post(std::function<R()> work)
+    {
+        auto promise = std::make_shared<std::promise<R>>();
+        std::future<R> future = promise->get_future();
+        bool queued = enqueue([promise, work = std::move(work)]() {
+            try {
+                promise->set_value(work());
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+        if (!queued) {
+            promise->set_exception(std::make_exception_ptr(DBBusyError("db executor overloaded")));
+        }
+        return future;
+    }
+
+    size_t threadCount() const { return workers_.size(); }
+    size_t queueCapacity() const { return queueCapacity_; }
+
+private:
+    struct QueuedJob {
+        Job job;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    template <typename R>
+    DBResult<R> run(const std::function<R(ConnectionPoolAgent&)>& work)
+    {
+        DBResult<R> result;
+        try {
+            if (!pool_) {
+                result.error = "no database connection";
+                return result;
+            }
+            ConnectionPoolAgent agent(pool_);
+            if (!agent) {
+                result.busy = agent.status() == CheckoutStatus::TIMEOUT;
+                result.error = result.busy ? "database busy" : "no database connection";
+                return result;
+            }
+            result.value = work(agent);
+            result.ok = true;
+        } catch (const std::exception& e) {
+            result.error = e.what();
+        }
+        return result;
+    }
+
+    void start(size_t threads);
+    bool enqueue(Job job);
+    void workerLoop();
+
+    DBConnPool* pool_; // 为空时只能 post
+    std::string name_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<QueuedJob> jobs_;
+    size_t queueCapacity_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+
+    MetricCounter* rejected_;
+    MetricGauge* depth_;
+    LatencyHistogram* queueWait_;
+    LatencyHistogram* runTime_;
+};
+
+DBExecutor& GetUserDBExecutor();
+DBExecutor& GetGameDBExecutor();
+// GS_STORAGE=memory 时玩家数据加载用，不连数据库
+DBExecutor& GetMemoryDBExecutor();
+
+#endif // DB_EXECUTOR_H
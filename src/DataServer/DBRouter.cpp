@@ -0,0 +1,112 @@
+#include "DBRouter.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 返回复制延迟（秒），复制未运行或查询失败返回 -1
+int64_t QueryReplicaLagSeconds(DBConnPool& pool)
+{
+    ConnectionPoolAgent db(&pool, chrono::milliseconds(200));
+    if (!db) return -1;
+
+    // 8.0.22 起是 SHOW REPLICA STATUS / Seconds_Behind_Source，老版本只认 SLAVE
+    const pair<const char*, const char*> variants[] = {
+        {"SHOW REPLICA STATUS", "Seconds_Behind_Source"},
+        {"SHOW SLAVE STATUS", "Seconds_Behind_Master"},
+    };
+    for (const auto& variant : variants) {
+        try {
+            unique_ptr<sql::Statement> stmt(db->createStatement());
+            unique_ptr<sql::ResultSet> rs(stmt->executeQuery(variant.first));
+            if (!rs->next()) return -1; // 不是副本
+            string lag = rs->getString(variant.second); // NULL（复制中断）时为空串
+            return lag.empty() ? -1 : strtoll(lag.c_str(), nullptr, 10);
+        } catch (const sql::SQLException&) {
+            continue;
+        }
+    }
+    return -1;
+}
+
+void StartReplicaLagMonitor(DBRouter& router)
+{
+    struct Probe {
+        size_t shard;
+        size_t replica;
+        MetricGauge* gauge;
+    };
+    vector<Probe> probes;
+    auto& registry = MetricsRegistry::getInstance();
+    for (size_t s = 0; s < router.shardCount(); ++s) {
+        for (size_t r = 0; r < router.replicaCount(s); ++r) {
+            string name = "db_gamedb_replica_lag_ms_" + to_string(s) + "_" + to_string(r);
+            probes.push_back({s, r, &registry.gauge(name, "Replication lag of a gamedb read replica, -1 if unknown")});
+            probes.back().gauge->set(-1);
+        }
+    }
+    if (probes.empty()) return;
+
+    // 路由是进程级单例，监控线程跟进程同生命周期
+    thread([&router, probes]() {
+        while (true) {
+            for (const auto& p : probes) {
+                int64_t seconds = QueryReplicaLagSeconds(router.replicaAt(p.shard, p.replica));
+                int64_t ms = seconds < 0 ? -1 : seconds * 1000;
+                router.setReplicaLag(p.shard, p.replica, chrono::milliseconds(ms));
+                p.gauge->set(ms);
+            }
+            this_thread::sleep_for(kReplicaLagInterval);
+        }
+    }).detach();
+}
+
+unique_ptr<DBRouter> BuildGameDBRouter(const DBConnInfo& info)
+{
+    const char* env = getenv("GS_GAMEDB_SHARDS");
+    vector<ShardHosts> topology = env ? ParseShardTopology(env) : vector<ShardHosts>{};
+    if (topology.empty()) {
+        topology.push_back(ShardHosts{info.host, {}});
+    }
+
+    // 其余分片主库和副本的指标名带上分片/副本编号，0 号分片主库是 GetGameDBPool()，仍是 db_gamedb_*
+    auto makePool = [&info](const string& host, const string& metricName) {
+        return make_shared<DBConnPool>(host, info.user, info.password, info.database, 10, 2, metricName);
+    };
+    vector<DBRouter::ShardSpec> shards;
+    for (const auto& hosts : topology) {
+        DBRouter::ShardSpec spec;
+        if (shards.empty()) {
+            // 0 号分片主库就是 GetGameDBPool()，执行器等不分片的调用方和路由共用这一个池
+            DBConnInfo shard0 = info;
+            shard0.host = hosts.primary;
+            spec.primary = shared_ptr<DBConnPool>(&GetGameDBPool(shard0), [](DBConnPool*) {});
+        } else {
+            spec.primary = makePool(hosts.primary, info.database + "_s" + to_string(shards.size()));
+        }
+        for (size_t r = 0; r < hosts.replicas.size(); ++r) {
+            spec.replicas.push_back(makePool(hosts.replicas[r], info.database + "_s" + to_string(shards.size()) + "_r" + to_string(r)));
+        }
+        LOG_INFO("gamedb shard %zu: primary %s, %zu replicas", shards.size(), hosts.primary.c_str(),
+                 hosts.replicas.size());
+        shards.push_back(std::move(spec));
+    }
+    return make_unique<DBRouter>(std::move(shards));
+}
+
+} // namespace
+
+DBRouter& GetGameDBRouter(DBConnInfo info)
+{
+    static unique_ptr<DBRouter> router = [&info]() {
+        auto built = BuildGameDBRouter(info);
+        StartReplicaLagMonitor(*built);
+        return built;
+    }();
+    return *router;
+}
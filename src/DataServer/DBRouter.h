@@ -0,0 +1,27 @@
+#ifndef DB_ROUTER_H
+#define DB_ROUTER_H
+
+#include <chrono>
+#include <string>
+#include "DBConnPool.h"
+#include "ShardRouter.h"
+
+using DBRouter = ShardRouter<DBConnPool>;
+
+/*
+    gamedb 的分片路由，按 username 选分片（见 ShardRouter.h）
+    - 拓扑由环境变量 GS_GAMEDB_SHARDS 给出，格式 "主库[|副本...];主库[|副本...]"，例如
+        GS_GAMEDB_SHARDS="tcp://10.0.0.1:3306|tcp://10.0.0.11:3306;tcp://10.0.0.2:3306"
+      未设置时只有 info.host 一个分片、没有副本，行为与原来的单库相同
+    - 所有分片共用 info 里的用户名、密码、库名
+    - 有副本时启动一个监控线程，每 kReplicaLagInterval 查一次复制延迟上报给路由，
+      导出为 db_gamedb_replica_lag_ms_<分片>_<副本>（-1 表示未知）
+    userdb 不分片：注册依赖 sys_user.username 的全局唯一键
+*/
+constexpr std::chrono::seconds kReplicaLagInterval{1};
+
+// 第一次调用（main 里）决定拓扑，之后的调用忽略参数；要在第一次 GetGameDBPool() 之前调用，
+// 0 号分片主库才会连到 GS_GAMEDB_SHARDS 里给的地址
+DBRouter& GetGameDBRouter(DBConnInfo info = {});
+
+#endif // DB_ROUTER_H
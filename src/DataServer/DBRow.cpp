@@ -0,0 +1,52 @@
+#include "DBRow.h"
+#include <cstring>
+
+using namespace std;
+
+string RowId(const TableSchema& table, const vector<DBValue>& keys)
+{
+    // 表名和每个键都带上类型/长度前缀，避免 ("ab","c") 与 ("a","bc") 撞在一起
+    string id;
+    id.reserve(table.name.size() + 1 + keys.size() * 16);
+    id += table.name;
+    id += '\0';
+    for (const auto& key : keys) {
+        id += static_cast<char>(key.index());
+        if (const int64_t* i = get_if<int64_t>(&key)) {
+            char buf[sizeof(int64_t)];
+            memcpy(buf, i, sizeof(buf));
+            id.append(buf, sizeof(buf));
+        } else if (const double* d = get_if<double>(&key)) {
+            char buf[sizeof(double)];
+            memcpy(buf, d, sizeof(buf));
+            id.append(buf, sizeof(buf));
+        } else {
+            const string& s = get<string>(key);
+            uint32_t len = static_cast<uint32_t>(s.size());
+            char buf[sizeof(len)];
+            memcpy(buf, &len, sizeof(buf));
+            id.append(buf, sizeof(buf));
+            id += s;
+        }
+    }
+    return id;
+}
+
+void MergeRowImage(RowImage& base, RowImage&& newer)
+{
+    if (!newer.isPartial()) {
+        base = std::move(newer);
+        return;
+    }
+    if (base.values.size() < newer.values.size()) {
+        base.values.resize(newer.values.size());
+    }
+    for (size_t i = 0; i < newer.values.size(); ++i) {
+        if (newer.dirty.test(i)) {
+            base.values[i] = std::move(newer.values[i]);
+        }
+    }
+    if (base.isPartial()) {
+        base.dirty |= newer.dirty;
+    }
+}
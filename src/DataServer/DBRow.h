@@ -0,0 +1,45 @@
+#ifndef DB_ROW_H
+#define DB_ROW_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+// 持久化层使用的列值，整数统一为 int64_t
+using DBValue = std::variant<int64_t, double, std::string>;
+
+// 值列的脏位，第 i 位对应 TableSchema::valueColumns[i]
+constexpr size_t kMaxValueColumns = 64;
+using ColumnMask = std::bitset<kMaxValueColumns>;
+
+// 一张表：主键列 + 值列（最多 kMaxValueColumns 个），RowImage 里的 keys / values 按这里的列顺序排列
+// 按指针分组和比较，必须是静态存储期的对象
+struct TableSchema {
+    std::string name;
+    std::vector<std::string> keyColumns;
+    std::vector<std::string> valueColumns;
+};
+
+// 一行的镜像：dirty 为空表示整行（upsert），否则只有 dirty 里的列有意义（UPDATE 这些列），
+// values 两种情况下都按 valueColumns 全长排列
+struct RowImage {
+    const TableSchema* table = nullptr;
+    std::vector<DBValue> keys;
+    std::vector<DBValue> values;
+    ColumnMask dirty;
+
+    bool isPartial() const { return dirty.any(); }
+};
+
+// 把同一行较新的镜像叠加到 base 上：整行直接替换；部分列覆盖对应位置并合并脏位
+// （base 是整行时结果仍是整行）
+void MergeRowImage(RowImage& base, RowImage&& newer);
+
+// 行标识：表名 + 主键的二进制编码，用来合并对同一行的多次写入
+std::string RowId(const TableSchema& table, const std::vector<DBValue>& keys);
+inline std::string RowId(const RowImage& row) { return RowId(*row.table, row.keys); }
+
+#endif // DB_ROW_H
@@ -0,0 +1,123 @@
+#include "MemoryRowStore.h"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+MemoryRowStore::MemoryRowStore(chrono::microseconds latency) : latency_(latency)
+{
+}
+
+void MemoryRowStore::delay() const
+{
+    if (latency_.count() > 0) {
+        this_thread::sleep_for(latency_);
+    }
+}
+
+shared_ptr<MemoryRowStore::Group> MemoryRowStore::findGroup(const TableSchema& table, const DBValue& owner) const
+{
+    shared_ptr<Group> g;
+    groups_.find(RowId(table, {owner}), g);
+    return g;
+}
+
+shared_ptr<MemoryRowStore::Group> MemoryRowStore::group(const TableSchema& table, const DBValue& owner, bool create)
+{
+    string id = RowId(table, {owner});
+    shared_ptr<Group> g;
+    if (groups_.find(id, g) || !create) {
+        return g;
+    }
+    groups_.insert(id, make_shared<Group>()); // 并发创建时以先插进去的为准
+    groups_.find(id, g);
+    return g;
+}
+
+bool MemoryRowStore::apply(const TableSchema& table, const vector<RowImage>& rows)
+{
+    delay();
+    // 先整批校验，坏行不会让前面的行已经落下
+    for (const auto& row : rows) {
+        if (row.keys.size() != table.keyColumns.size() || row.values.size() != table.valueColumns.size()) {
+            throw invalid_argument("row does not match table " + table.name);
+        }
+    }
+
+    // 涉及的组按地址排序后一起加锁，读者看到的要么是整批之前、要么是整批之后
+    vector<shared_ptr<Group>> targets;
+    targets.reserve(rows.size());
+    vector<Group*> order;
+    for (const auto& row : rows) {
+        targets.push_back(group(table, row.keys.front(), !row.isPartial()));
+        if (targets.back()) {
+            order.push_back(targets.back().get());
+        }
+    }
+    sort(order.begin(), order.end());
+    order.erase(unique(order.begin(), order.end()), order.end());
+    vector<unique_lock<mutex>> locks;
+    locks.reserve(order.size());
+    for (Group* g : order) {
+        locks.emplace_back(g->mu);
+    }
+
+    for (size_t r = 0; r < rows.size(); ++r) {
+        const RowImage& row = rows[r];
+        Group* g = targets[r].get();
+        if (!g) {
+            continue; // 部分列更新一个不存在的行
+        }
+        vector<DBValue> rest(row.keys.begin() + 1, row.keys.end());
+        if (!row.isPartial()) {
+            g->rows[std::move(rest)] = row.values;
+            continue;
+        }
+        auto it = g->rows.find(rest);
+        if (it == g->rows.end()) {
+            continue;
+        }
+        for (size_t i = 0; i < row.values.size(); ++i) {
+            if (row.dirty.test(i)) {
+                it->second[i] = row.values[i];
+            }
+        }
+    }
+    return true;
+}
+
+WriteBehindStore::BatchWriter MemoryRowStore::writer()
+{
+    return [this](const TableSchema& table, const vector<RowImage>& rows) { return apply(table, rows); };
+}
+
+vector<RowImage> MemoryRowStore::selectByOwner(const TableSchema& table, const DBValue& owner) const
+{
+    delay();
+    vector<RowImage> result;
+    shared_ptr<Group> g = findGroup(table, owner);
+    if (!g) {
+        return result;
+    }
+    lock_guard<mutex> lk(g->mu);
+    result.reserve(g->rows.size());
+    for (const auto& [rest, values] : g->rows) {
+        RowImage row{&table, {owner}, values, {}};
+        row.keys.insert(row.keys.end(), rest.begin(), rest.end());
+        result.push_back(std::move(row));
+    }
+    return result;
+}
+
+size_t MemoryRowStore::rowCount() const
+{
+    size_t n = 0;
+    for (size_t shard = 0; shard < groups_.shardCount(); ++shard) {
+        groups_.forEachInShard(shard, [&n](const string&, const shared_ptr<Group>& g) {
+            lock_guard<mutex> lk(g->mu);
+            n += g->rows.size();
+        });
+    }
+    return n;
+}
@@ -0,0 +1,50 @@
+#ifndef MEMORY_ROW_STORE_H
+#define MEMORY_ROW_STORE_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DBRow.h"
+#include "ShardedMap.h"
+#include "WriteBehindStore.h"
+
+/*
+    MySQL 表的内存替身（GS_STORAGE=memory），写入语义与 MysqlRowWriter 相同：
+    - 整行镜像 upsert；部分列镜像只改已存在的行的脏列，行不存在时忽略（同 UPDATE 影响 0 行）
+    - 行按（表, 第一个主键列）归组，即按玩家归组，selectByOwner 取一个玩家在一张表里的所有行，
+      按其余主键升序返回
+    组之间用 ShardedMap 分片加锁，组内一把锁；每次 apply / selectByOwner 先 sleep latency，模拟一次往返
+    apply 对一批行是原子的（同 MysqlRowWriter 的一个事务）：先整批校验，再把涉及的组一起锁住写入
+*/
+class MemoryRowStore {
+public:
+    explicit MemoryRowStore(std::chrono::microseconds latency = std::chrono::microseconds(0));
+    MemoryRowStore(const MemoryRowStore&) = delete;
+    MemoryRowStore& operator=(const MemoryRowStore&) = delete;
+
+    bool apply(const TableSchema& table, const std::vector<RowImage>& rows);
+    // 给 WriteBehindStore 用的 BatchWriter，store 的生命周期要长于返回的 writer
+    WriteBehindStore::BatchWriter writer();
+
+    std::vector<RowImage> selectByOwner(const TableSchema& table, const DBValue& owner) const;
+    size_t rowCount() const;
+
+private:
+    struct Group {
+        mutable std::mutex mu;
+        std::map<std::vector<DBValue>, std::vector<DBValue>> rows; // 其余主键 -> 值列
+    };
+
+    std::shared_ptr<Group> group(const TableSchema& table, const DBValue& owner, bool create);
+    std::shared_ptr<Group> findGroup(const TableSchema& table, const DBValue& owner) const;
+    void delay() const;
+
+    std::chrono::microseconds latency_;
+    ShardedMap<std::string, std::shared_ptr<Group>> groups_; // RowId(table, {owner}) -> 组
+};
+
+#endif // MEMORY_ROW_STORE_H
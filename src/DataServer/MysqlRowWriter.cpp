@@ -0,0 +1,190 @@
+#include "MysqlRowWriter.h"
+#include "LogM.h"
+#include "Metrics.h"
+#include <cstdio>
+#include <type_traits>
+
+using namespace std;
+
+void BindDBValue(sql::PreparedStatement* pstmt, unsigned int index, const DBValue& value)
+{
+    if (const int64_t* i = get_if<int64_t>(&value)) {
+        pstmt->setInt64(index, *i);
+    } else if (const double* d = get_if<double>(&value)) {
+        pstmt->setDouble(index, *d);
+    } else {
+        pstmt->setString(index, get<string>(value));
+    }
+}
+
+static string BuildUpsertSql(const TableSchema& table, size_t rows)
+{
+    string sql = "INSERT INTO " + table.name + " (";
+    string placeholders = "(";
+    bool first = true;
+    for (const auto* columns : {&table.keyColumns, &table.valueColumns}) {
+        for (const auto& column : *columns) {
+            if (!first) {
+                sql += ", ";
+                placeholders += ", ";
+            }
+            sql += column;
+            placeholders += "?";
+            first = false;
+        }
+    }
+    placeholders += ")";
+
+    sql += ") VALUES ";
+    for (size_t i = 0; i < rows; ++i) {
+        if (i > 0) sql += ", ";
+        sql += placeholders;
+    }
+
+    sql += " ON DUPLICATE KEY UPDATE ";
+    for (size_t i = 0; i < table.valueColumns.size(); ++i) {
+        if (i > 0) sql += ", ";
+        sql += table.valueColumns[i] + " = VALUES(" + table.valueColumns[i] + ")";
+    }
+    return sql;
+}
+
+static void ExecuteUpsert(ConnectionPoolAgent& db, const TableSchema& table,
+                          const vector<RowImage>& rows, size_t begin, size_t count)
+{
+    sql::PreparedStatement* pstmt = db.prepare(BuildUpsertSql(table, count));
+    unsigned int index = 1;
+    for (size_t r = begin; r < begin + count; ++r) {
+        for (const auto& key : rows[r].keys) BindDBValue(pstmt, index++, key);
+        for (const auto& value : rows[r].values) BindDBValue(pstmt, index++, value);
+    }
+    pstmt->executeUpdate();
+}
+
+static string BuildUpdateSql(const TableSchema& table, const ColumnMask& dirty)
+{
+    string sql = "UPDATE " + table.name + " SET ";
+    bool first = true;
+    for (size_t i = 0; i < table.valueColumns.size(); ++i) {
+        if (!dirty.test(i)) continue;
+        if (!first) sql += ", ";
+        sql += table.valueColumns[i] + " = ?";
+        first = false;
+    }
+    sql += " WHERE ";
+    for (size_t i = 0; i < table.keyColumns.size(); ++i) {
+        if (i > 0) sql += " AND ";
+        sql += table.keyColumns[i] + " = ?";
+    }
+    return sql;
+}
+
+// 同一脏列集合的行共用一条预编译 UPDATE，逐行重设参数执行
+// 影响 0 行说明行不存在（建档的整行没落库）或值没变，改动不会落库，记下来
+static void ExecuteUpdates(ConnectionPoolAgent& db, const TableSchema& table, const vector<RowImage>& rows)
+{
+    static auto& missed = MetricsRegistry::getInstance().counter(
+        "writebehind_update_missed_total", "Partial-column UPDATEs that matched no row");
+    const ColumnMask& dirty = rows.front().dirty;
+    sql::PreparedStatement* pstmt = db.prepare(BuildUpdateSql(table, dirty));
+    for (const auto& row : rows) {
+        unsigned int index = 1;
+        for (size_t i = 0; i < table.valueColumns.size(); ++i) {
+            if (dirty.test(i)) BindDBValue(pstmt, index++, row.values[i]);
+        }
+        for (const auto& key : row.keys) BindDBValue(pstmt, index++, key);
+        if (pstmt->executeUpdate() == 0) {
+            missed.inc();
+            LOG_WARN("UPDATE %s matched no row (missing row or unchanged values)", table.name.c_str());
+        }
+    }
+}
+
+WriteBehindStore::BatchWriter MakeMysqlUpsertWriter(DBConnPool& pool)
+{
+    return [&pool](const TableSchema& table, const vector<RowImage>& rows) {
+        if (rows.empty()) return true;
+        if (table.valueColumns.empty() || table.valueColumns.size() > kMaxValueColumns) {
+            LOG_ERROR("Table %s has %zu value columns, cannot write", table.name.c_str(), table.valueColumns.size());
+            return false;
+        }
+
+        ConnectionPoolAgent db(&pool);
+        if (!db) {
+            LOG_ERROR("Failed to get database connection for %s", table.name.c_str());
+            return false;
+        }
+
+        try {
+            db->setAutoCommit(false);
+            if (rows.front().isPartial()) {
+                ExecuteUpdates(db, table, rows);
+            } else {
+                size_t begin = 0;
+                while (begin < rows.size()) {
+                    size_t count = 1;
+                    while (count * 2 <= rows.size() - begin) count *= 2;
+                    ExecuteUpsert(db, table, rows, begin, count);
+                    begin += count;
+                }
+            }
+            db->commit();
+            db->setAutoCommit(true);
+            return true;
+        } catch (const sql::SQLException& e) {
+            LOG_ERROR("Write to %s failed: %s (code %d)", table.name.c_str(), e.what(), e.getErrorCode());
+            try {
+                db->rollback();
+                db->setAutoCommit(true);
+            } catch (const sql::SQLException&) {
+                // 连接多半已经断了，归还时 isClosed 会把它丢掉
+            }
+            return false;
+        }
+    };
+}
+
+// 分片键统一转成字符串再哈希，username 以外的类型也有确定的分片
+static string ShardKeyOf(const DBValue& key)
+{
+    return visit([](const auto& v) -> string {
+        using T = decay_t<decltype(v)>;
+        if constexpr (is_same_v<T, string>) {
+            return v;
+        } else if constexpr (is_same_v<T, int64_t>) {
+            return to_string(v);
+        } else {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%.17g", v);
+            return buf;
+        }
+    }, key);
+}
+
+WriteBehindStore::BatchWriter MakeShardedUpsertWriter(DBRouter& router)
+{
+    vector<WriteBehindStore::BatchWriter> writers;
+    for (size_t i = 0; i < router.shardCount(); ++i) {
+        writers.push_back(MakeMysqlUpsertWriter(router.primaryAt(i)));
+    }
+    return [&router, writers](const TableSchema& table, const vector<RowImage>& rows) {
+        if (writers.size() == 1) {
+            return writers[0](table, rows);
+        }
+        if (table.keyColumns.empty()) {
+            LOG_ERROR("Table %s has no key columns, cannot pick a shard", table.name.c_str());
+            return false;
+        }
+        vector<vector<RowImage>> byShard(writers.size());
+        for (const auto& row : rows) {
+            byShard[router.shardFor(ShardKeyOf(row.keys.front()))].push_back(row);
+        }
+        bool ok = true;
+        for (size_t i = 0; i < byShard.size(); ++i) {
+            if (!byShard[i].empty() && !writers[i](table, byShard[i])) {
+                ok = false;
+            }
+        }
+        return ok;
+    };
+}
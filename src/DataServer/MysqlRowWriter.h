@@ -0,0 +1,27 @@
+#ifndef MYSQL_ROW_WRITER_H
+#define MYSQL_ROW_WRITER_H
+
+#include "DBConnPool.h"
+#include "DBRouter.h"
+#include "DBRow.h"
+#include "WriteBehindStore.h"
+
+// 按 DBValue 的类型调用 setInt64 / setDouble / setString，index 从 1 开始
+void BindDBValue(sql::PreparedStatement* pstmt, unsigned int index, const DBValue& value);
+
+/*
+    WriteBehindStore 的 MySQL 写入，一批行在同一个事务里提交，要么全写进去要么都不写
+    - 整行：写成多行
+        INSERT INTO t (k.., v..) VALUES (?,..),(?,..) ON DUPLICATE KEY UPDATE v=VALUES(v),..
+      批内行数按 2 的幂拆开（256、128 ...），每张表最多 9 种 SQL，都能留在连接的语句缓存里
+    - 部分列（同一批脏列集合相同）：UPDATE t SET 脏列=? .. WHERE k=? ..，预编译一次逐行执行；
+      只更新已存在的行，新行要先以整行 put 建档
+    - 借不到连接（池耗尽/超时）直接返回 false，由 WriteBehindStore 重新排队
+*/
+WriteBehindStore::BatchWriter MakeMysqlUpsertWriter(DBConnPool& pool);
+
+// 分片版本：按第一个主键列（username）把一批行拆到各分片主库，每个分片一个事务；
+// 任何一个分片失败整批返回 false，重试时已成功的分片再写一遍（upsert/UPDATE 可以重放）
+WriteBehindStore::BatchWriter MakeShardedUpsertWriter(DBRouter& router);
+
+#endif // MYSQL_ROW_WRITER_H
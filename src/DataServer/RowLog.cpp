@@ -0,0 +1,431 @@
+#include "RowLog.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'S', 'W', 'A', 'L', 0, 0, 1};
+constexpr size_t kSyncBytes = 1 << 20;      // 缓冲超过它就不等 syncWindow
+
+enum ValueTag : uint8_t { TAG_INT = 0, TAG_DOUBLE = 1, TAG_STRING = 2 };
+
+uint32_t Crc32(const char* data, size_t len)
+{
+    static const array<uint32_t, 256> table = []() {
+        array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void PutLE(string& out, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>(v >> (8 * i)));
+    }
+}
+
+// 读越界时 ok 置 false，之后的读取都返回 0
+struct Reader {
+    const char* p;
+    const char* end;
+    bool ok = true;
+
+    uint64_t le(int bytes) {
+        if (!ok || end - p < bytes) {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) {
+            v |= static_cast<uint64_t>(static_cast<unsigned char>(*p++)) << (8 * i);
+        }
+        return v;
+    }
+
+    string bytes(size_t n) {
+        if (!ok || static_cast<size_t>(end - p) < n) {
+            ok = false;
+            return {};
+        }
+        string s(p, n);
+        p += n;
+        return s;
+    }
+};
+
+void EncodeValue(string& out, const DBValue& value)
+{
+    if (const auto* i = get_if<int64_t>(&value)) {
+        out.push_back(static_cast<char>(TAG_INT));
+        PutLE(out, static_cast<uint64_t>(*i), 8);
+    } else if (const auto* d = get_if<double>(&value)) {
+        uint64_t bits;
+        memcpy(&bits, d, sizeof(bits));
+        out.push_back(static_cast<char>(TAG_DOUBLE));
+        PutLE(out, bits, 8);
+    } else {
+        const string& s = get<string>(value);
+        out.push_back(static_cast<char>(TAG_STRING));
+        PutLE(out, s.size(), 4);
+        out.append(s);
+    }
+}
+
+DBValue DecodeValue(Reader& in)
+{
+    switch (in.le(1)) {
+    case TAG_INT:
+        return static_cast<int64_t>(in.le(8));
+    case TAG_DOUBLE: {
+        uint64_t bits = in.le(8);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+    case TAG_STRING:
+        return in.bytes(in.le(4));
+    default:
+        in.ok = false;
+        return int64_t{0};
+    }
+}
+
+// 记录：[长度 4][CRC32 4][表名长 2][表名][脏位 8][主键数 1][值列数 1][DBValue...]
+void EncodeRecord(string& out, const RowImage& row)
+{
+    string payload;
+    const string& table = row.table->name;
+    PutLE(payload, table.size(), 2);
+    payload.append(table);
+    PutLE(payload, row.dirty.to_ullong(), 8);
+    PutLE(payload, row.keys.size(), 1);
+    PutLE(payload, row.values.size(), 1);
+    for (const auto& key : row.keys) EncodeValue(payload, key);
+    for (const auto& value : row.values) EncodeValue(payload, value);
+
+    PutLE(out, payload.size(), 4);
+    PutLE(out, Crc32(payload.data(), payload.size()), 4);
+    out.append(payload);
+}
+
+bool ReadFile(const string& path, string& out)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    char buf[64 * 1024];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0 || (n < 0 && errno == EINTR)) {
+        if (n > 0) out.append(buf, static_cast<size_t>(n));
+    }
+    ::close(fd);
+    return n == 0;
+}
+
+bool WriteAll(int fd, const string& data)
+{
+    size_t off = 0;
+    while (off < data.size()) {
+        ssize_t n = ::write(fd, data.data() + off, data.size() - off);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        off += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+RowLog::RowLog(const string& dir, const string& name, Options options)
+    : dir_(dir), name_(name), options_(options)
+{
+    options_.syncWindow = max(options_.syncWindow, chrono::milliseconds(1));
+    if (::mkdir(dir_.c_str(), 0700) != 0 && errno != EEXIST) {
+        throw runtime_error("RowLog: cannot create " + dir_ + ", errno=" + to_string(errno));
+    }
+    DIR* d = ::opendir(dir_.c_str());
+    if (!d) {
+        throw runtime_error("RowLog: cannot open " + dir_ + ", errno=" + to_string(errno));
+    }
+    ::closedir(d);
+
+    vector<uint64_t> existing = listSegments();
+    firstOwnSegment_ = existing.empty() ? 1 : existing.back() + 1;
+    currentSegment_ = firstOwnSegment_;
+
+    auto& registry = MetricsRegistry::getInstance();
+    string prefix = "wal_" + name_;
+    bytes_ = &registry.counter(prefix + "_bytes_total", "Bytes written to the " + name_ + " write-ahead log");
+    errors_ = &registry.counter(prefix + "_errors_total", "Failed writes or fdatasyncs on the " + name_ + " write-ahead log");
+    fsyncTime_ = &registry.histogram(prefix + "_fsync_us", "Group commit (write + fdatasync) time for the " + name_ + " write-ahead log");
+
+    syncer_ = thread([this]() { syncerLoop(); });
+}
+
+RowLog::~RowLog()
+{
+    stop();
+}
+
+string RowLog::segmentPath(uint64_t segment) const
+{
+    char file[64];
+    snprintf(file, sizeof(file), "-%016llu.wal", static_cast<unsigned long long>(segment));
+    return dir_ + "/" + name_ + file;
+}
+
+vector<uint64_t> RowLog::listSegments() const
+{
+    vector<uint64_t> segments;
+    DIR* d = ::opendir(dir_.c_str());
+    if (!d) return segments;
+    string prefix = name_ + "-";
+    while (dirent* entry = ::readdir(d)) {
+        string file = entry->d_name;
+        if (file.size() != prefix.size() + 16 + 4 || file.compare(0, prefix.size(), prefix) != 0 ||
+            file.compare(file.size() - 4, 4, ".wal") != 0) {
+            continue;
+        }
+        segments.push_back(strtoull(file.c_str() + prefix.size(), nullptr, 10));
+    }
+    ::closedir(d);
+    sort(segments.begin(), segments.end());
+    return segments;
+}
+
+void RowLog::append(const RowImage& row)
+{
+    string record;
+    EncodeRecord(record, row);
+
+    lock_guard<mutex> lk(mu_);
+    if (buffer_.empty() || buffer_.back().segment != currentSegment_) {
+        buffer_.push_back(Chunk{currentSegment_, {}});
+    }
+    buffer_.back().bytes.append(record);
+    bufferedBytes_ += record.size();
+    currentDirty_ = true;
+    if (bufferedBytes_ >= kSyncBytes) {
+        syncCv_.notify_one();
+    }
+}
+
+uint64_t RowLog::rotate()
+{
+    lock_guard<mutex> lk(mu_);
+    if (currentDirty_) {
+        ++currentSegment_;
+        currentDirty_ = false;
+    }
+    return currentSegment_ - 1;
+}
+
+void RowLog::release(uint64_t upTo)
+{
+    lock_guard<mutex> io(ioMu_);
+    releasedUpTo_ = max(releasedUpTo_, upTo);
+    if (fd_ >= 0 && fdSegment_ <= upTo) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    for (uint64_t segment : listSegments()) {
+        if (segment > upTo) break;
+        if (!replayed_ && segment < firstOwnSegment_) continue;
+        if (::unlink(segmentPath(segment).c_str()) != 0 && errno != ENOENT) {
+            LOG_ERROR("RowLog %s: unlink segment %llu failed, errno=%d", name_.c_str(),
+                      (unsigned long long)segment, errno);
+        }
+    }
+}
+
+bool RowLog::writeChunks()
+{
+    vector<Chunk> chunks;
+    {
+        lock_guard<mutex> lk(mu_);
+        chunks.swap(buffer_);
+        bufferedBytes_ = 0;
+    }
+    if (chunks.empty()) {
+        return true;
+    }
+
+    auto start = chrono::steady_clock::now();
+    bool ok = true;
+    for (const auto& chunk : chunks) {
+        if (chunk.segment <= releasedUpTo_) {
+            continue; // 这些行已经落库，段也删了
+        }
+        if (fd_ < 0 || fdSegment_ != chunk.segment) {
+            if (fd_ >= 0) {
+                ok = ::fdatasync(fd_) == 0 && ok;
+                ::close(fd_);
+            }
+            fdSegment_ = chunk.segment;
+            fd_ = ::open(segmentPath(chunk.segment).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+            struct stat st;
+            if (fd_ < 0 || ::fstat(fd_, &st) != 0 ||
+                (st.st_size == 0 && !WriteAll(fd_, string(kMagic, sizeof(kMagic))))) {
+                LOG_ERROR("RowLog %s: open segment %llu failed, errno=%d", name_.c_str(),
+                          (unsigned long long)chunk.segment, errno);
+                if (fd_ >= 0) ::close(fd_);
+                fd_ = -1;
+                ok = false;
+                continue;
+            }
+        }
+        if (!WriteAll(fd_, chunk.bytes)) {
+            LOG_ERROR("RowLog %s: write failed, errno=%d", name_.c_str(), errno);
+            ok = false;
+            continue;
+        }
+        bytes_->inc(chunk.bytes.size());
+    }
+    if (fd_ >= 0 && ::fdatasync(fd_) != 0) {
+        LOG_ERROR("RowLog %s: fdatasync failed, errno=%d", name_.c_str(), errno);
+        ok = false;
+    }
+    if (!ok) {
+        // 写不进去的记录不重试：对应的行仍在写回队列里，只是这段时间内崩溃无法恢复
+        errors_->inc();
+    }
+    fsyncTime_->observe(chrono::steady_clock::now() - start);
+    return ok;
+}
+
+void RowLog::syncerLoop()
+{
+    unique_lock<mutex> lk(mu_);
+    while (true) {
+        syncCv_.wait_for(lk, options_.syncWindow, [this]() {
+            return stopping_ || syncRequests_ > syncsDone_ || bufferedBytes_ >= kSyncBytes;
+        });
+        bool stop = stopping_;
+        uint64_t requested = syncRequests_;
+        lk.unlock();
+        bool ok;
+        {
+            lock_guard<mutex> io(ioMu_);
+            ok = writeChunks();
+        }
+        lk.lock();
+        syncsDone_ = requested;
+        lastSyncOk_ = ok;
+        syncedCv_.notify_all();
+        if (stop) break;
+    }
+}
+
+bool RowLog::sync()
+{
+    unique_lock<mutex> lk(mu_);
+    if (stopping_) {
+        lk.unlock();
+        lock_guard<mutex> io(ioMu_);
+        return writeChunks();
+    }
+    uint64_t ticket = ++syncRequests_;
+    syncCv_.notify_one();
+    syncedCv_.wait(lk, [this, ticket]() { return syncsDone_ >= ticket; });
+    return lastSyncOk_;
+}
+
+void RowLog::stop()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    syncCv_.notify_all();
+    if (syncer_.joinable()) {
+        syncer_.join();
+    }
+    lock_guard<mutex> io(ioMu_);
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t RowLog::replay(const SchemaResolver& resolve, const function<void(RowImage&&)>& apply)
+{
+    size_t replayed = 0;
+    size_t skipped = 0;
+    for (uint64_t segment : listSegments()) {
+        if (segment >= firstOwnSegment_) break;
+        string path = segmentPath(segment);
+        string data;
+        if (!ReadFile(path, data)) {
+            LOG_ERROR("RowLog %s: cannot read %s, errno=%d", name_.c_str(), path.c_str(), errno);
+            continue;
+        }
+        if (data.size() < sizeof(kMagic) || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+            LOG_ERROR("RowLog %s: %s has a bad header, skipped", name_.c_str(), path.c_str());
+            continue;
+        }
+
+        Reader file{data.data() + sizeof(kMagic), data.data() + data.size()};
+        while (file.p != file.end) {
+            size_t len = file.le(4);
+            uint32_t crc = static_cast<uint32_t>(file.le(4));
+            string payload = file.bytes(len);
+            if (!file.ok || Crc32(payload.data(), payload.size()) != crc) {
+                // 崩溃时写了一半的尾部，之后不会再有完整记录
+                LOG_ERROR("RowLog %s: torn or corrupt record in %s, dropping the rest of the segment",
+                          name_.c_str(), path.c_str());
+                break;
+            }
+
+            Reader in{payload.data(), payload.data() + payload.size()};
+            string tableName = in.bytes(in.le(2));
+            ColumnMask dirty(in.le(8));
+            size_t keyCount = in.le(1);
+            size_t valueCount = in.le(1);
+            RowImage row{resolve(tableName), {}, {}, dirty};
+            for (size_t i = 0; i < keyCount && in.ok; ++i) row.keys.push_back(DecodeValue(in));
+            for (size_t i = 0; i < valueCount && in.ok; ++i) row.values.push_back(DecodeValue(in));
+            if (!in.ok || !row.table || row.keys.size() != row.table->keyColumns.size() ||
+                row.values.size() != row.table->valueColumns.size()) {
+                ++skipped;
+                continue;
+            }
+            apply(std::move(row));
+            ++replayed;
+        }
+    }
+    {
+        lock_guard<mutex> io(ioMu_);
+        replayed_ = true;
+    }
+    if (replayed > 0 || skipped > 0) {
+        LOG_INFO("RowLog %s: replayed %zu records, skipped %zu", name_.c_str(), replayed, skipped);
+    }
+    return replayed;
+}
@@ -0,0 +1,98 @@
+#ifndef ROW_LOG_H
+#define ROW_LOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DBRow.h"
+
+class MetricCounter;
+class LatencyHistogram;
+
+/*
+    写回存储前面的本地预写日志（WAL）：WriteBehindStore 每接受一次 put 就先 append 一条记录，
+    进程崩溃时两次 flush 之间的改动可以从日志里找回来
+    - 记录是二进制的：长度 + CRC32 + (表名, 脏位, 主键, 值列)，小端；段文件开头是 8 字节魔数
+        <dir>/<name>-<段号 16 位十进制>.wal
+    - 组提交：append 只拷进内存缓冲，后台线程每 syncWindow（或缓冲超过 1MB）把缓冲写进段文件并 fdatasync
+      一次，崩溃最多丢最近 syncWindow 的改动；sync() 立即落盘并等待完成
+    - 截断：WriteBehindStore 每次 flush 开始时 rotate() 封住当前段并 sync() 落盘后才写库，这次 flush 完全成功后 release()
+      删掉封住的段——段里每条记录对应的行要么在这次 flush 里，要么更早已经落库
+    - 重放：构造时目录里已有的段属于上一个进程，replay() 按写入顺序读出来（CRC 不对或残缺的尾部丢弃），
+      交回写回存储重新落库；它们也是"已封住"的段，下一次成功的 flush 之后删除
+    指标前缀 wal_<name>_：bytes_total、fsync_us、errors_total
+*/
+class RowLog {
+public:
+    struct Options {
+        std::chrono::milliseconds syncWindow{10};
+    };
+
+    // 表名 -> schema，重放时用；不认识的表返回 nullptr，该记录跳过
+    using SchemaResolver = std::function<const TableSchema*(const std::string&)>;
+
+    // 目录不存在时创建（0700），打不开时抛 std::runtime_error
+    RowLog(const std::string& dir, const std::string& name, Options options);
+    ~RowLog();
+    RowLog(const RowLog&) = delete;
+    RowLog& operator=(const RowLog&) = delete;
+
+    void append(const RowImage& row);
+    // 封住当前段（没有新记录时不换段），返回最后一个被封住的段号，0 表示没有
+    uint64_t rotate();
+    // 删除段号 <= upTo 的段；上一个进程留下的段要等 replay() 之后才删
+    void release(uint64_t upTo);
+    // 把缓冲立即写盘并 fdatasync，失败返回 false
+    bool sync();
+    void stop();
+
+    size_t replay(const SchemaResolver& resolve, const std::function<void(RowImage&&)>& apply);
+
+private:
+    struct Chunk {
+        uint64_t segment;
+        std::string bytes;
+    };
+
+    std::string segmentPath(uint64_t segment) const;
+    std::vector<uint64_t> listSegments() const;
+    void syncerLoop();
+    bool writeChunks();
+
+    std::string dir_;
+    std::string name_;
+    Options options_;
+
+    std::mutex mu_;
+    std::condition_variable syncCv_;
+    std::condition_variable syncedCv_;
+    std::vector<Chunk> buffer_;
+    size_t bufferedBytes_ = 0;
+    uint64_t currentSegment_ = 1;
+    bool currentDirty_ = false;    // 当前段有没有记录
+    uint64_t firstOwnSegment_ = 1; // 小于它的段是上一个进程留下的
+    uint64_t syncRequests_ = 0;
+    uint64_t syncsDone_ = 0;
+    bool lastSyncOk_ = true;
+    bool stopping_ = false;
+
+    std::mutex ioMu_; // 写盘和删段互斥，删掉的段不会被晚到的写入重新建出来
+    uint64_t releasedUpTo_ = 0;
+    bool replayed_ = false; // replay() 之前不删上一个进程留下的段
+    int fd_ = -1;
+    uint64_t fdSegment_ = 0;
+
+    std::thread syncer_;
+
+    MetricCounter* bytes_;
+    MetricCounter* errors_;
+    LatencyHistogram* fsyncTime_;
+};
+
+#endif // ROW_LOG_H
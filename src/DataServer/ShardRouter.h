@@ -0,0 +1,159 @@
+#ifndef SHARD_ROUTER_H
+#define SHARD_ROUTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 64 位 FNV-1a：分片路由要求跨进程、跨版本稳定，不能用 std::hash
+inline uint64_t HashShardKey(std::string_view key)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// Lamping & Veach 的 jump consistent hash：分片数从 n 加到 n+1 时只有约 1/(n+1) 的键换分片
+inline size_t JumpConsistentHash(uint64_t key, size_t buckets)
+{
+    int64_t b = -1;
+    int64_t j = 0;
+    while (j < static_cast<int64_t>(buckets)) {
+        b = j;
+        key = key * 2862933555777941757ull + 1;
+        j = static_cast<int64_t>((b + 1) * (static_cast<double>(1ll << 31) / static_cast<double>((key >> 33) + 1)));
+    }
+    return static_cast<size_t>(b);
+}
+
+// 分片拓扑："主库[|副本|副本...];主库[|副本...]"，空段忽略
+struct ShardHosts {
+    std::string primary;
+    std::vector<std::string> replicas;
+};
+
+inline std::vector<ShardHosts> ParseShardTopology(std::string_view spec)
+{
+    auto split = [](std::string_view s, char sep) {
+        std::vector<std::string_view> parts;
+        size_t begin = 0;
+        while (begin <= s.size()) {
+            size_t end = s.find(sep, begin);
+            if (end == std::string_view::npos) end = s.size();
+            if (end > begin) parts.push_back(s.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        return parts;
+    };
+
+    std::vector<ShardHosts> shards;
+    for (std::string_view shard : split(spec, ';')) {
+        auto hosts = split(shard, '|');
+        if (hosts.empty()) continue;
+        ShardHosts parsed;
+        parsed.primary = std::string(hosts[0]);
+        for (size_t i = 1; i < hosts.size(); ++i) {
+            parsed.replicas.emplace_back(hosts[i]);
+        }
+        shards.push_back(std::move(parsed));
+    }
+    return shards;
+}
+
+/*
+    按用户键（目前是 username）把请求路由到 N 个分片，每个分片一个主库 + 若干只读副本
+    Backend 是 DBConnPool，测试里可以换成任意类型
+    - 写和要求读到最新数据的读走 primary(key)
+    - 能容忍旧数据的读走 reader(key, maxStaleness)：在延迟已知且不超过 maxStaleness 的副本之间轮询，
+      没有合格副本时回到主库
+    - 副本延迟由外部监控（见 DBRouter.h）通过 setReplicaLag 上报，未知的副本不参与读
+    分片数确定后不能随意改：改了之后 jump hash 会把一部分用户路由到新分片，需要先迁数据
+*/
+template <typename Backend>
+class ShardRouter {
+public:
+    using BackendPtr = std::shared_ptr<Backend>;
+
+    struct ShardSpec {
+        BackendPtr primary;
+        std::vector<BackendPtr> replicas;
+    };
+
+    explicit ShardRouter(std::vector<ShardSpec> shards) {
+        if (shards.empty()) {
+            throw std::invalid_argument("ShardRouter needs at least one shard");
+        }
+        for (auto& spec : shards) {
+            if (!spec.primary) {
+                throw std::invalid_argument("ShardRouter shard without primary");
+            }
+            auto shard = std::make_unique<Shard>();
+            shard->primary = std::move(spec.primary);
+            for (auto& replica : spec.replicas) {
+                auto r = std::make_unique<Replica>();
+                r->backend = std::move(replica);
+                shard->replicas.push_back(std::move(r));
+            }
+            shards_.push_back(std::move(shard));
+        }
+    }
+
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    size_t shardCount() const { return shards_.size(); }
+    size_t shardFor(std::string_view key) const { return JumpConsistentHash(HashShardKey(key), shards_.size()); }
+
+    Backend& primary(std::string_view key) { return *shards_[shardFor(key)]->primary; }
+    Backend& primaryAt(size_t shard) { return *shards_.at(shard)->primary; }
+
+    Backend& reader(std::string_view key, std::chrono::milliseconds maxStaleness) {
+        Shard& shard = *shards_[shardFor(key)];
+        size_t n = shard.replicas.size();
+        if (n == 0) return *shard.primary;
+
+        size_t start = shard.next.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < n; ++i) {
+            Replica& r = *shard.replicas[(start + i) % n];
+            int64_t lag = r.lagMs.load(std::memory_order_relaxed);
+            if (lag >= 0 && lag <= maxStaleness.count()) {
+                return *r.backend;
+            }
+        }
+        return *shard.primary;
+    }
+
+    size_t replicaCount(size_t shard) const { return shards_.at(shard)->replicas.size(); }
+    Backend& replicaAt(size_t shard, size_t replica) { return *shards_.at(shard)->replicas.at(replica)->backend; }
+
+    // 监控线程上报副本延迟；lag 为负表示未知（复制中断、查询失败），该副本暂不参与读
+    void setReplicaLag(size_t shard, size_t replica, std::chrono::milliseconds lag) {
+        shards_.at(shard)->replicas.at(replica)->lagMs.store(lag.count() < 0 ? -1 : lag.count(),
+                                                             std::memory_order_relaxed);
+    }
+
+private:
+    struct Replica {
+        BackendPtr backend;
+        std::atomic<int64_t> lagMs{-1};
+    };
+
+    struct Shard {
+        BackendPtr primary;
+        std::vector<std::unique_ptr<Replica>> replicas;
+        std::atomic<size_t> next{0}; // 副本轮询游标
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // SHARD_ROUTER_H
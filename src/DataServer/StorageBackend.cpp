@@ -0,0 +1,21 @@
+#include "StorageBackend.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+StorageKind ConfiguredStorage()
+{
+    static const StorageKind kind = []() {
+        const char* env = getenv("GS_STORAGE");
+        return env && strcmp(env, "memory") == 0 ? StorageKind::MEMORY : StorageKind::MYSQL;
+    }();
+    return kind;
+}
+
+chrono::microseconds MemoryStoreLatency()
+{
+    const char* env = getenv("GS_MEMSTORE_LATENCY_US");
+    long us = env ? strtol(env, nullptr, 10) : 0;
+    return chrono::microseconds(us > 0 ? us : 0);
+}
@@ -0,0 +1,21 @@
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <chrono>
+
+/*
+    用户数据（UserStore）和玩家数据（PlayerStorage）落在哪里，由环境变量 GS_STORAGE 选择：
+    - 未设置或 mysql：userdb / gamedb（默认）
+    - memory：进程内哈希表，不连 MySQL、启动时不问密码，重启后数据丢失；
+      用来在单机上压测整条登录链路，避免结果被数据库和网络抖动淹没
+    GS_MEMSTORE_LATENCY_US 给内存实现的每次操作加一段 sleep，模拟数据库往返（默认 0）
+*/
+enum class StorageKind {
+    MYSQL,
+    MEMORY
+};
+
+StorageKind ConfiguredStorage();
+std::chrono::microseconds MemoryStoreLatency();
+
+#endif // STORAGE_BACKEND_H
@@ -0,0 +1,236 @@
+#include "WriteBehindStore.h"
+#include "RowLog.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <algorithm>
+#include <exception>
+#include <map>
+
+using namespace std;
+
+WriteBehindStore::WriteBehindStore(const string& name, BatchWriter writer, Options options)
+    : name_(name), writer_(std::move(writer)), options_(options)
+{
+    options_.batchRows = max<size_t>(1, options_.batchRows);
+    options_.maxPendingRows = max(options_.maxPendingRows, options_.batchRows);
+
+    auto& registry = MetricsRegistry::getInstance();
+    string prefix = "writebehind_" + name_;
+    pendingGauge_ = &registry.gauge(prefix + "_pending_rows", "Dirty rows waiting to be written to " + name_);
+    coalesced_ = &registry.counter(prefix + "_coalesced_total", "Writes merged into a row already pending for " + name_);
+    rejected_ = &registry.counter(prefix + "_rejected_total", "Writes rejected because the " + name_ + " write-behind queue was full");
+    rowsWritten_ = &registry.counter(prefix + "_rows_written_total", "Rows flushed to " + name_);
+    flushErrors_ = &registry.counter(prefix + "_flush_errors_total", "Failed write-behind batches for " + name_);
+    flushTime_ = &registry.histogram(prefix + "_flush_us", "Time to flush all dirty rows to " + name_);
+
+    flusher_ = thread([this]() { flusherLoop(); });
+}
+
+WriteBehindStore::~WriteBehindStore()
+{
+    stop();
+}
+
+bool WriteBehindStore::put(RowImage row, chrono::milliseconds maxBlock)
+{
+    string id = RowId(row);
+    unique_lock<mutex> lk(mu_);
+    if (stopping_) {
+        rejected_->inc();
+        return false;
+    }
+
+    auto it = pending_.find(id);
+    if (it != pending_.end()) {
+        if (options_.log) options_.log->append(row);
+        MergeRowImage(it->second, std::move(row));
+        coalesced_->inc();
+        return true;
+    }
+
+    // 正在写的行已经占了名额，再 put 只是在 pending_ 里排一份新镜像，写失败时两者合并
+    if (inFlight_.count(id) == 0 && queuedRows_ >= options_.maxPendingRows) {
+        flushCv_.notify_one();
+        spaceCv_.wait_for(lk, maxBlock, [this]() {
+            return stopping_ || queuedRows_ < options_.maxPendingRows;
+        });
+        if (stopping_ || queuedRows_ >= options_.maxPendingRows) {
+            rejected_->inc();
+            return false;
+        }
+    }
+
+    // 在 mu_ 内追加，保证日志段封住时段里每条记录的行都已经在 pending_ 里
+    if (options_.log) options_.log->append(row);
+    if (inFlight_.count(id) == 0) {
+        ++queuedRows_;
+    }
+    pending_.emplace(std::move(id), std::move(row));
+    pendingGauge_->set(static_cast<int64_t>(queuedRows_));
+    if (pending_.size() >= options_.batchRows) {
+        flushCv_.notify_one();
+    }
+    return true;
+}
+
+bool WriteBehindStore::flush()
+{
+    lock_guard<mutex> flushLock(flushMu_);
+    auto start = chrono::steady_clock::now();
+
+    unordered_map<string, RowImage> dirty;
+    uint64_t sealed = 0; // 这次 flush 覆盖的日志段，完全成功后可以删掉
+    {
+        lock_guard<mutex> lk(mu_);
+        dirty.swap(pending_);
+        for (const auto& entry : dirty) {
+            inFlight_.insert(entry.first);
+        }
+        if (options_.log) sealed = options_.log->rotate();
+    }
+    if (dirty.empty()) {
+        {
+            lock_guard<mutex> lk(mu_);
+            lastCleanFlush_ = start;
+        }
+        if (sealed > 0) options_.log->release(sealed);
+        return true;
+    }
+    // 写库之前先让封住的段落盘：这批行写失败或写到一半进程崩溃，重放还能把它们找回来
+    if (sealed > 0 && !options_.log->sync()) {
+        LOG_ERROR("WriteBehindStore %s: syncing the row log failed, writing without it", name_.c_str());
+    }
+
+    // 按（表, 脏列集合）分组：同一组的行用同一条 SQL，整行的脏位为 0
+    map<pair<const TableSchema*, unsigned long long>, vector<RowImage>> byTable;
+    for (auto& entry : dirty) {
+        RowImage& row = entry.second;
+        byTable[{row.table, row.dirty.to_ullong()}].push_back(std::move(row));
+    }
+
+    // 一批失败后剩下的不再尝试，数据库多半不可用，留给下一轮
+    bool ok = true;
+    vector<RowImage> failed;
+    for (auto& tableRows : byTable) {
+        auto& rows = tableRows.second;
+        for (size_t begin = 0; begin < rows.size(); begin += options_.batchRows) {
+            size_t end = min(rows.size(), begin + options_.batchRows);
+            vector<RowImage> batch(make_move_iterator(rows.begin() + begin), make_move_iterator(rows.begin() + end));
+            bool written = false;
+            if (ok) {
+                try {
+                    written = writer_(*tableRows.first.first, batch);
+                } catch (const exception& e) {
+                    LOG_ERROR("WriteBehindStore %s: writing %s failed: %s", name_.c_str(),
+                              tableRows.first.first->name.c_str(), e.what());
+                }
+            }
+            if (written) {
+                rowsWritten_->inc(batch.size());
+                finishInFlight(batch);
+                continue;
+            }
+            if (ok) flushErrors_->inc();
+            ok = false;
+            for (auto& row : batch) {
+                failed.push_back(std::move(row));
+            }
+        }
+    }
+
+    if (ok) {
+        {
+            lock_guard<mutex> lk(mu_);
+            lastCleanFlush_ = start;
+        }
+        if (sealed > 0) options_.log->release(sealed);
+    }
+    if (!failed.empty()) {
+        lock_guard<mutex> lk(mu_);
+        for (auto& row : failed) {
+            // flush 期间又被 put 过的行：失败的旧镜像垫底，新镜像叠在上面，部分列更新不会丢
+            // 名额在 flush 开始时就占着，重新排队不改变 queuedRows_
+            string id = RowId(row);
+            inFlight_.erase(id);
+            auto it = pending_.find(id);
+            if (it == pending_.end()) {
+                pending_.emplace(std::move(id), std::move(row));
+                continue;
+            }
+            RowImage newer = std::move(it->second);
+            it->second = std::move(row);
+            MergeRowImage(it->second, std::move(newer));
+        }
+        pendingGauge_->set(static_cast<int64_t>(queuedRows_));
+        LOG_ERROR("WriteBehindStore %s: %zu rows requeued after a failed flush", name_.c_str(), failed.size());
+    }
+
+    flushTime_->observe(chrono::steady_clock::now() - start);
+    return ok;
+}
+
+void WriteBehindStore::stop()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    flushCv_.notify_all();
+    spaceCv_.notify_all();
+    if (flusher_.joinable()) {
+        flusher_.join();
+    }
+
+    if (!flush()) {
+        LOG_ERROR("WriteBehindStore %s: %zu rows were not persisted at shutdown", name_.c_str(), pendingRows());
+    }
+}
+
+void WriteBehindStore::finishInFlight(const vector<RowImage>& batch)
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        for (const auto& row : batch) {
+            string id = RowId(row);
+            inFlight_.erase(id);
+            // 写的过程中又有新镜像排进 pending_ 的行仍占着名额
+            if (pending_.count(id) == 0) {
+                --queuedRows_;
+            }
+        }
+        pendingGauge_->set(static_cast<int64_t>(queuedRows_));
+    }
+    spaceCv_.notify_all();
+}
+
+size_t WriteBehindStore::pendingRows()
+{
+    lock_guard<mutex> lk(mu_);
+    return queuedRows_;
+}
+
+chrono::steady_clock::time_point WriteBehindStore::lastCleanFlush()
+{
+    lock_guard<mutex> lk(mu_);
+    return lastCleanFlush_;
+}
+
+void WriteBehindStore::flusherLoop()
+{
+    unique_lock<mutex> lk(mu_);
+    while (!stopping_) {
+        flushCv_.wait_for(lk, options_.flushInterval, [this]() {
+            return stopping_ || pending_.size() >= options_.batchRows;
+        });
+        if (stopping_) break;
+
+        lk.unlock();
+        bool ok = flush();
+        lk.lock();
+        if (!ok) {
+            // 失败后队列马上又是满的，不能立刻重试，等一个周期（stop 可以打断）
+            flushCv_.wait_for(lk, options_.flushInterval, [this]() { return stopping_; });
+        }
+    }
+}
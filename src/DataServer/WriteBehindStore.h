@@ -0,0 +1,97 @@
+#ifndef WRITE_BEHIND_STORE_H
+#define WRITE_BEHIND_STORE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "DBRow.h"
+
+class MetricCounter;
+class MetricGauge;
+class LatencyHistogram;
+class RowLog;
+
+/*
+    写回（write-behind）持久化：业务代码只 put 一行的最新镜像，后台线程批量落库，
+    游戏逻辑里的每次改动都不会同步打到 MySQL
+        GetPlayerStore().put(ToRow(character));
+    - 同一行在落库前的多次 put 合并成一次（按 RowId）：整行镜像直接替换，
+      只带脏列的部分镜像（RowImage::dirty）叠加到已有镜像上，脏位取并集
+    - 每 flushInterval，或待写行数达到 batchRows 时提前，把脏行按（表, 脏列集合）分组交给 BatchWriter，
+      同一批的列集合相同，可以复用同一条语句（MySQL 实现见 MysqlRowWriter.h：
+      整行走多行 INSERT ... ON DUPLICATE KEY UPDATE，部分列走只含这些列的 UPDATE）
+    - 写失败的整批重新排队（flush 期间同一行又有 put 时，新镜像叠加在失败的旧镜像上），
+      并按 flushInterval 退避重试
+    - 背压：待写行数（排队的加上正在写的，同一行只算一次）达到 maxPendingRows 时新行的 put
+      最多阻塞 maxBlock，仍满则返回 false；名额在一批真正写成功后才释放，写失败重新排队的行不会超限。
+      已在队列里或正在写的行再次 put 不受限制
+    - 配了 options.log 时，被接受的 put 先追加到预写日志，完全成功的 flush 之后截掉已落库的日志段
+    - stop()（析构时也会调）停掉后台线程并做最后一次 flush
+    指标前缀 writebehind_<name>_：pending_rows、coalesced_total、rejected_total、
+    rows_written_total、flush_errors_total、flush_us
+*/
+class WriteBehindStore {
+public:
+    // 同一张表、同一脏列集合的一批行，全部写入成功返回 true；可以抛异常，按失败处理
+    using BatchWriter = std::function<bool(const TableSchema&, const std::vector<RowImage>&)>;
+
+    struct Options {
+        std::chrono::milliseconds flushInterval{5000};
+        size_t batchRows = 256;          // 提前 flush 的阈值，也是交给 writer 的单批行数上限
+        size_t maxPendingRows = 100000;
+        RowLog* log = nullptr;           // 可选的预写日志，生命周期由调用方管理，见 RowLog.h
+    };
+
+    WriteBehindStore(const std::string& name, BatchWriter writer, Options options);
+    ~WriteBehindStore();
+    WriteBehindStore(const WriteBehindStore&) = delete;
+    WriteBehindStore& operator=(const WriteBehindStore&) = delete;
+
+    bool put(RowImage row, std::chrono::milliseconds maxBlock = std::chrono::milliseconds(0));
+
+    // 同步写出当前所有脏行，失败的行留在队列里；返回是否全部成功
+    bool flush();
+    void stop();
+
+    // 排队和正在写的行数，即背压计算用的数字
+    size_t pendingRows();
+    // 最近一次完全成功的 flush 的开始时间：在它之前 put 的行都已经落库
+    std::chrono::steady_clock::time_point lastCleanFlush();
+    const Options& options() const { return options_; }
+
+private:
+    void flusherLoop();
+    void finishInFlight(const std::vector<RowImage>& batch);
+
+    std::string name_;
+    BatchWriter writer_;
+    Options options_;
+
+    std::mutex mu_;
+    std::condition_variable flushCv_; // 唤醒后台线程：攒够一批或 stop
+    std::condition_variable spaceCv_; // 唤醒因背压阻塞的 put
+    std::unordered_map<std::string, RowImage> pending_;
+    std::unordered_set<std::string> inFlight_; // 当前 flush 正在写、还没有结果的行
+    size_t queuedRows_ = 0;                    // pending_ ∪ inFlight_ 的行数
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point lastCleanFlush_{};
+
+    std::mutex flushMu_; // 串行化 flush，保证同一行的新旧镜像按 put 顺序落库
+    std::thread flusher_;
+
+    MetricGauge* pendingGauge_;
+    MetricCounter* coalesced_;
+    MetricCounter* rejected_;
+    MetricCounter* rowsWritten_;
+    MetricCounter* flushErrors_;
+    LatencyHistogram* flushTime_;
+};
+
+#endif // WRITE_BEHIND_STORE_H
@@ -0,0 +1,101 @@
+#include "PlayerStorage.h"
+#include "DBExecutor.h"
+#include "MemoryRowStore.h"
+#include "PlayerLoadStage.h"
+#include <future>
+
+using namespace std;
+
+namespace {
+
+int64_t AsInt(const DBValue& v) { return get<int64_t>(v); }
+
+// MemoryRowStore 里的行按 PlayerTables 的列顺序还原成结构体
+class MemoryPlayerStorage : public PlayerStorage {
+public:
+    explicit MemoryPlayerStorage(chrono::microseconds latency) : rows_(latency) {}
+
+    // 和 MySQL 实现一样四个阶段同时提交，每个阶段的模拟往返并行发生
+    PlayerLoadStatus load(const string& username, optional<PlayerCharacter>& character,
+                          PlayerData& out, PlayerLoadTimings& timings) override
+    {
+        auto start = chrono::steady_clock::now();
+        auto characterF = submitStage<optional<PlayerCharacter>>([this, username]() { return queryCharacter(username); });
+        auto inventoryF = submitStage<vector<InventoryItem>>([this, username]() { return queryInventory(username); });
+        auto questsF = submitStage<vector<QuestProgress>>([this, username]() { return queryQuests(username); });
+        auto friendsF = submitStage<vector<FriendEntry>>([this, username]() { return queryFriends(username); });
+
+        auto deadline = start + kPlayerLoadTimeout;
+        PlayerLoadStatus status = PlayerLoadStatus::OK;
+        CollectStage("character", characterF, deadline, character, timings.character, status);
+        CollectStage("inventory", inventoryF, deadline, out.inventory, timings.inventory, status);
+        CollectStage("quests", questsF, deadline, out.quests, timings.quests, status);
+        CollectStage("friends", friendsF, deadline, out.friends, timings.friends, status);
+        return status;
+    }
+
+    WriteBehindStore::BatchWriter writer() override { return rows_.writer(); }
+
+private:
+    template <typename R>
+    static future<StageResult<R>> submitStage(function<R()> query)
+    {
+        return GetMemoryDBExecutor().post<StageResult<R>>(
+            [query = std::move(query)]() { return RunStage<R>(query); });
+    }
+
+    optional<PlayerCharacter> queryCharacter(const string& username) const
+    {
+        auto rows = rows_.selectByOwner(PlayerCharacterTable(), DBValue(username));
+        if (rows.empty()) {
+            return nullopt;
+        }
+        const auto& v = rows.front().values;
+        PlayerCharacter c;
+        c.username = username;
+        c.characterId = AsInt(v[0]);
+        c.level = AsInt(v[1]);
+        c.exp = AsInt(v[2]);
+        c.gold = AsInt(v[3]);
+        c.sceneId = AsInt(v[4]);
+        c.posX = get<double>(v[5]);
+        c.posY = get<double>(v[6]);
+        return c;
+    }
+
+    vector<InventoryItem> queryInventory(const string& username) const
+    {
+        vector<InventoryItem> items;
+        for (const auto& row : rows_.selectByOwner(PlayerInventoryTable(), DBValue(username))) {
+            items.push_back(InventoryItem{AsInt(row.keys[1]), AsInt(row.values[0]), AsInt(row.values[1])});
+        }
+        return items;
+    }
+
+    vector<QuestProgress> queryQuests(const string& username) const
+    {
+        vector<QuestProgress> quests;
+        for (const auto& row : rows_.selectByOwner(PlayerQuestTable(), DBValue(username))) {
+            quests.push_back(QuestProgress{AsInt(row.keys[1]), AsInt(row.values[0]), AsInt(row.values[1])});
+        }
+        return quests;
+    }
+
+    vector<FriendEntry> queryFriends(const string& username) const
+    {
+        vector<FriendEntry> friends;
+        for (const auto& row : rows_.selectByOwner(PlayerFriendTable(), DBValue(username))) {
+            friends.push_back(FriendEntry{get<string>(row.keys[1]), AsInt(row.values[0])});
+        }
+        return friends;
+    }
+
+    MemoryRowStore rows_;
+};
+
+} // namespace
+
+unique_ptr<PlayerStorage> MakeMemoryPlayerStorage(chrono::microseconds latency)
+{
+    return make_unique<MemoryPlayerStorage>(latency);
+}
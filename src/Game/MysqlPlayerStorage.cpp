@@ -0,0 +1,117 @@
+#include "PlayerStorage.h"
+#include "DBExecutor.h"
+#include "DBRouter.h"
+#include "MysqlRowWriter.h"
+#include "PlayerLoadStage.h"
+#include <future>
+
+using namespace std;
+
+namespace {
+
+// 提交到 gamedb 执行器，在 pool（玩家所在分片的主库）上查询，在 DB 线程上计时
+template <typename R>
+future<StageResult<R>> SubmitStage(DBConnPool& pool, function<R(ConnectionPoolAgent&)> query)
+{
+    return GetGameDBExecutor().submit<StageResult<R>>(pool,
+        [query = std::move(query)](ConnectionPoolAgent& db) { return RunStage<R>([&]() { return query(db); }); });
+}
+
+optional<PlayerCharacter> QueryCharacter(ConnectionPoolAgent& db, const string& username)
+{
+    sql::PreparedStatement* pstmt = db.prepare(
+        "SELECT character_id, level, exp, gold, scene_id, pos_x, pos_y FROM player_character WHERE username = ?");
+    pstmt->setString(1, username);
+    unique_ptr<sql::ResultSet> rs(pstmt->executeQuery());
+    if (!rs->next()) {
+        return nullopt;
+    }
+    PlayerCharacter c;
+    c.username = username;
+    c.characterId = rs->getInt64(1);
+    c.level = rs->getInt64(2);
+    c.exp = rs->getInt64(3);
+    c.gold = rs->getInt64(4);
+    c.sceneId = rs->getInt64(5);
+    c.posX = rs->getDouble(6);
+    c.posY = rs->getDouble(7);
+    return c;
+}
+
+vector<InventoryItem> QueryInventory(ConnectionPoolAgent& db, const string& username)
+{
+    sql::PreparedStatement* pstmt = db.prepare(
+        "SELECT slot, item_id, item_count FROM player_inventory WHERE username = ?");
+    pstmt->setString(1, username);
+    unique_ptr<sql::ResultSet> rs(pstmt->executeQuery());
+    vector<InventoryItem> items;
+    while (rs->next()) {
+        items.push_back(InventoryItem{rs->getInt64(1), rs->getInt64(2), rs->getInt64(3)});
+    }
+    return items;
+}
+
+vector<QuestProgress> QueryQuests(ConnectionPoolAgent& db, const string& username)
+{
+    sql::PreparedStatement* pstmt = db.prepare(
+        "SELECT quest_id, state, progress FROM player_quest WHERE username = ?");
+    pstmt->setString(1, username);
+    unique_ptr<sql::ResultSet> rs(pstmt->executeQuery());
+    vector<QuestProgress> quests;
+    while (rs->next()) {
+        quests.push_back(QuestProgress{rs->getInt64(1), rs->getInt64(2), rs->getInt64(3)});
+    }
+    return quests;
+}
+
+vector<FriendEntry> QueryFriends(ConnectionPoolAgent& db, const string& username)
+{
+    sql::PreparedStatement* pstmt = db.prepare(
+        "SELECT friend_name, added_at FROM player_friend WHERE username = ?");
+    pstmt->setString(1, username);
+    unique_ptr<sql::ResultSet> rs(pstmt->executeQuery());
+    vector<FriendEntry> friends;
+    while (rs->next()) {
+        friends.push_back(FriendEntry{rs->getString(1), rs->getInt64(2)});
+    }
+    return friends;
+}
+
+class MysqlPlayerStorage : public PlayerStorage {
+public:
+    PlayerLoadStatus load(const string& username, optional<PlayerCharacter>& character,
+                          PlayerData& out, PlayerLoadTimings& timings) override;
+    WriteBehindStore::BatchWriter writer() override { return MakeShardedUpsertWriter(GetGameDBRouter()); }
+};
+
+PlayerLoadStatus MysqlPlayerStorage::load(const string& username, optional<PlayerCharacter>& character,
+                                          PlayerData& out, PlayerLoadTimings& timings)
+{
+    auto start = chrono::steady_clock::now();
+    // 装配结果会被修改后写回，四条查询都必须读分片主库
+    DBConnPool& primary = GetGameDBRouter().primary(username);
+    // 四条查询同时提交，各占一个执行器线程和一个池连接
+    auto characterF = SubmitStage<optional<PlayerCharacter>>(primary,
+        [username](ConnectionPoolAgent& db) { return QueryCharacter(db, username); });
+    auto inventoryF = SubmitStage<vector<InventoryItem>>(primary,
+        [username](ConnectionPoolAgent& db) { return QueryInventory(db, username); });
+    auto questsF = SubmitStage<vector<QuestProgress>>(primary,
+        [username](ConnectionPoolAgent& db) { return QueryQuests(db, username); });
+    auto friendsF = SubmitStage<vector<FriendEntry>>(primary,
+        [username](ConnectionPoolAgent& db) { return QueryFriends(db, username); });
+
+    auto deadline = start + kPlayerLoadTimeout;
+    PlayerLoadStatus status = PlayerLoadStatus::OK;
+    CollectStage("character", characterF, deadline, character, timings.character, status);
+    CollectStage("inventory", inventoryF, deadline, out.inventory, timings.inventory, status);
+    CollectStage("quests", questsF, deadline, out.quests, timings.quests, status);
+    CollectStage("friends", friendsF, deadline, out.friends, timings.friends, status);
+    return status;
+}
+
+} // namespace
+
+unique_ptr<PlayerStorage> MakeMysqlPlayerStorage()
+{
+    return make_unique<MysqlPlayerStorage>();
+}
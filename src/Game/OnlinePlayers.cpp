@@ -0,0 +1,159 @@
+#include "PlayerLoader.h"
+#include "EventLoop.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include "WriteBehindStore.h"
+#include <future>
+
+using namespace std;
+
+OnlinePlayers::OnlinePlayers(WriteBehindStore& store, Loader loader)
+    : store_(store), loader_(std::move(loader))
+{
+}
+
+PlayerLoadStatus OnlinePlayers::acquire(const string& username, shared_ptr<PlayerData>& out,
+                                        PlayerLoadTimings* timings)
+{
+    static auto& resident = MetricsRegistry::getInstance().counter(
+        "player_load_resident_total", "Logins that reused a player already in memory");
+
+    Resident cur;
+    if (players_.find(username, cur)) {
+        if (cur.released) {
+            players_.insertOrAssign(username, Resident{cur.data, false, {}});
+        }
+        if (timings) timings->resident = true;
+        resident.inc();
+        out = cur.data;
+        return PlayerLoadStatus::OK;
+    }
+
+    PlayerLoadTimings local;
+    auto data = make_shared<PlayerData>();
+    PlayerLoadStatus status = loader_(username, *data, timings ? *timings : local);
+    if (status != PlayerLoadStatus::OK) {
+        return status;
+    }
+    // 同一账号并发登录时只保留先装好的一份
+    if (!players_.insert(username, Resident{data, false, {}}) && players_.find(username, cur)) {
+        data = cur.data;
+    }
+    out = std::move(data);
+    return PlayerLoadStatus::OK;
+}
+
+void OnlinePlayers::markOnline(const string& username, shared_ptr<PlayerData> data)
+{
+    players_.insertOrAssign(username, Resident{std::move(data), false, {}});
+}
+
+void OnlinePlayers::release(const string& username)
+{
+    Resident cur;
+    if (players_.find(username, cur) && !cur.released) {
+        // 先把最后的改动交给写回存储，sweep 按 releasedAt 判断它们是否已落库
+        // 存储拒收时脏位放回去，保持常驻，由 saveDirty 继续重试
+        RowImage row;
+        if (cur.data->character.takeDirtyRow(row) && !store_.put(row)) {
+            cur.data->character.restoreDirty(row);
+            LOG_WARN("Player store is full, unsaved changes of %s stay resident", username.c_str());
+        }
+        players_.insertOrAssign(username, Resident{cur.data, true, chrono::steady_clock::now()});
+    }
+}
+
+shared_ptr<PlayerData> OnlinePlayers::get(const string& username) const
+{
+    Resident cur;
+    return players_.find(username, cur) ? cur.data : nullptr;
+}
+
+void OnlinePlayers::startSweep(EventLoop* loop)
+{
+    loop->runEvery(kSaveInterval, [this]() { saveDirty(); });
+    loop->runEvery(kSweepInterval, [this]() { sweep(); });
+}
+
+size_t OnlinePlayers::saveDirty()
+{
+    // 锁内只摘脏列，put 放到锁外；拒收的行把脏位放回原玩家，下一轮再交
+    struct Pending {
+        string username;
+        Resident resident;
+        RowImage row;
+    };
+    vector<Pending> rows;
+    for (size_t shard = 0; shard < players_.shardCount(); ++shard) {
+        players_.forEachInShard(shard, [&rows](const string& username, const Resident& r) {
+            RowImage row;
+            if (r.data->character.takeDirtyRow(row)) {
+                rows.push_back(Pending{username, r, std::move(row)});
+            }
+        });
+    }
+    size_t saved = 0, rejected = 0;
+    for (auto& p : rows) {
+        if (!store_.put(p.row)) {
+            p.resident.data->character.restoreDirty(p.row);
+            ++rejected;
+            continue;
+        }
+        ++saved;
+        // 已下线玩家补交的改动：重新计时，sweep 要等覆盖这次 put 的 flush
+        Resident cur;
+        if (p.resident.released && players_.find(p.username, cur) && cur.data == p.resident.data && cur.released) {
+            players_.insertOrAssign(p.username, Resident{cur.data, true, chrono::steady_clock::now()});
+        }
+    }
+    if (rejected > 0) {
+        LOG_WARN("Player store is full, %zu dirty characters kept for the next save", rejected);
+    }
+    return saved;
+}
+
+size_t OnlinePlayers::saveAllDirty()
+{
+    size_t saved = saveDirty();
+    bool unsaved = false;
+    for (size_t shard = 0; shard < players_.shardCount() && !unsaved; ++shard) {
+        players_.forEachInShard(shard, [&unsaved](const string&, const Resident& r) {
+            unsaved = unsaved || r.data->character.hasUnsaved();
+        });
+    }
+    if (unsaved && store_.flush()) {
+        saved += saveDirty();
+    }
+    return saved;
+}
+
+size_t OnlinePlayers::saveOnShutdown(EventLoop* loop, chrono::milliseconds timeout)
+{
+    // TrackedCharacter 只能在 loop 线程上碰
+    if (!loop || loop->isInLoopThread()) {
+        return saveAllDirty();
+    }
+    auto done = make_shared<promise<size_t>>();
+    future<size_t> saved = done->get_future();
+    loop->queueInLoop([this, done]() { done->set_value(saveAllDirty()); });
+    if (saved.wait_for(timeout) != future_status::ready) {
+        LOG_ERROR("Saving online players at shutdown timed out, unsaved changes are lost");
+        return 0;
+    }
+    return saved.get();
+}
+
+size_t OnlinePlayers::sweep()
+{
+    auto flushed = store_.lastCleanFlush();
+    size_t dropped = 0;
+    for (size_t shard = 0; shard < players_.shardCount(); ++shard) {
+        dropped += players_.eraseIfInShard(shard, [flushed](const string&, const Resident& r) {
+            return r.released && r.releasedAt < flushed && !r.data->character.hasUnsaved();
+        });
+    }
+    if (dropped > 0) {
+        LOG_DEBUG("Dropped %zu offline players, %zu still resident", dropped, players_.size());
+    }
+    return dropped;
+}
@@ -0,0 +1,93 @@
+#include "PlayerLoader.h"
+#include "PlayerStorage.h"
+#include "StorageBackend.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include "WriteBehindStore.h"
+#include <optional>
+
+using namespace std;
+
+namespace {
+
+LatencyHistogram& StageHistogram(const char* stage)
+{
+    return MetricsRegistry::getInstance().histogram(
+        string("player_load_") + stage + "_us", string("Time to query player ") + stage + " at login");
+}
+
+// 加载失败时没完成的阶段耗时为 0，不计入
+void ObserveStage(LatencyHistogram& hist, chrono::microseconds elapsed, PlayerLoadStatus status)
+{
+    if (status == PlayerLoadStatus::OK || elapsed.count() > 0) {
+        hist.observe(elapsed);
+    }
+}
+
+} // namespace
+
+PlayerStorage& GetPlayerStorage()
+{
+    static unique_ptr<PlayerStorage> storage = []() {
+        if (ConfiguredStorage() == StorageKind::MEMORY) {
+            LOG_INFO("Player data kept in memory (GS_STORAGE=memory)");
+            return MakeMemoryPlayerStorage(MemoryStoreLatency());
+        }
+        return MakeMysqlPlayerStorage();
+    }();
+    return *storage;
+}
+
+PlayerLoadStatus LoadPlayerData(const string& username, PlayerData& out, PlayerLoadTimings& timings)
+{
+    static auto& characterHist = StageHistogram("character");
+    static auto& inventoryHist = StageHistogram("inventory");
+    static auto& questsHist = StageHistogram("quests");
+    static auto& friendsHist = StageHistogram("friends");
+    static auto& totalHist = MetricsRegistry::getInstance().histogram(
+        "player_load_us", "Wall time to assemble a player at login");
+
+    auto start = chrono::steady_clock::now();
+    optional<PlayerCharacter> loadedCharacter;
+    PlayerLoadStatus status = GetPlayerStorage().load(username, loadedCharacter, out, timings);
+    ObserveStage(characterHist, timings.character, status);
+    ObserveStage(inventoryHist, timings.inventory, status);
+    ObserveStage(questsHist, timings.quests, status);
+    ObserveStage(friendsHist, timings.friends, status);
+
+    auto elapsed = chrono::steady_clock::now() - start;
+    totalHist.observe(elapsed);
+    timings.total = chrono::duration_cast<chrono::microseconds>(elapsed);
+    if (status != PlayerLoadStatus::OK) {
+        return status;
+    }
+
+    if (loadedCharacter) {
+        out.character = TrackedCharacter(std::move(*loadedCharacter));
+    } else {
+        // 第一次进游戏：默认角色，以整行交给写回存储建档，之后的改动才能走部分列 UPDATE；
+        // 存储拒收时留着未建档标记，saveDirty 下一轮再带整行过去
+        PlayerCharacter fresh;
+        fresh.username = username;
+        out.character = TrackedCharacter(std::move(fresh));
+        out.character.markUnsaved();
+        RowImage row;
+        if (out.character.takeDirtyRow(row) && !GetPlayerStore().put(row)) {
+            out.character.restoreDirty(row);
+            LOG_WARN("Player store is full, default character for %s will be saved later", username.c_str());
+        }
+        LOG_INFO("Created default character for %s", username.c_str());
+    }
+
+    LOG_DEBUG("Player %s loaded in %lld us (character %lld, inventory %lld, quests %lld, friends %lld)",
+              username.c_str(), (long long)timings.total.count(), (long long)timings.character.count(),
+              (long long)timings.inventory.count(), (long long)timings.quests.count(),
+              (long long)timings.friends.count());
+    return PlayerLoadStatus::OK;
+}
+
+OnlinePlayers& OnlinePlayers::getInstance()
+{
+    static OnlinePlayers instance(GetPlayerStore(), LoadPlayerData);
+    return instance;
+}
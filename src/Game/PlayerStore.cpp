@@ -0,0 +1,80 @@
+#include "PlayerTables.h"
+#include "PlayerStorage.h"
+#include "RowLog.h"
+#include "WriteBehindStore.h"
+#include "LogM.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+using namespace std;
+
+static chrono::milliseconds PlayerFlushInterval()
+{
+    const char* env = getenv("GS_PLAYER_FLUSH_MS");
+    long ms = env ? strtol(env, nullptr, 10) : 0;
+    return chrono::milliseconds(ms > 0 ? ms : 5000);
+}
+
+// 空或 off 表示不写预写日志
+static string PlayerLogDir()
+{
+    const char* env = getenv("GS_PLAYER_WAL_DIR");
+    if (!env) return "player_wal";
+    return strcmp(env, "off") == 0 ? "" : env;
+}
+
+static chrono::milliseconds PlayerLogSyncWindow()
+{
+    const char* env = getenv("GS_PLAYER_WAL_SYNC_MS");
+    long ms = env ? strtol(env, nullptr, 10) : 0;
+    return chrono::milliseconds(ms > 0 ? ms : 10);
+}
+
+RowLog* GetPlayerLog()
+{
+    static unique_ptr<RowLog> log = []() -> unique_ptr<RowLog> {
+        string dir = PlayerLogDir();
+        if (dir.empty()) {
+            LOG_INFO("Player write-ahead log disabled");
+            return nullptr;
+        }
+        try {
+            return make_unique<RowLog>(dir, "player", RowLog::Options{PlayerLogSyncWindow()});
+        } catch (const exception& e) {
+            LOG_ERROR("Player write-ahead log unavailable, running without it: %s", e.what());
+            return nullptr;
+        }
+    }();
+    return log.get();
+}
+
+WriteBehindStore& GetPlayerStore()
+{
+    static WriteBehindStore store("gamedb", GetPlayerStorage().writer(),
+                                  WriteBehindStore::Options{PlayerFlushInterval(), 256, 100000, GetPlayerLog()});
+    return store;
+}
+
+size_t ReplayPlayerLog()
+{
+    RowLog* log = GetPlayerLog();
+    if (!log) {
+        return 0;
+    }
+    auto& store = GetPlayerStore();
+    size_t rejected = 0;
+    size_t replayed = log->replay(FindPlayerTable, [&store, &rejected](RowImage&& row) {
+        // 后台线程按 batchRows 边收边写，队列满时等它腾地方
+        if (!store.put(std::move(row), chrono::seconds(30))) {
+            ++rejected;
+        }
+    });
+    if (rejected > 0) {
+        LOG_ERROR("Player log replay: %zu records rejected by the write-behind queue", rejected);
+    }
+    if (replayed > 0 && !store.flush()) {
+        LOG_ERROR("Player log replay: flush failed, %zu rows stay queued", store.pendingRows());
+    }
+    return replayed;
+}
@@ -0,0 +1,90 @@
+#include "PlayerTables.h"
+
+using namespace std;
+
+const TableSchema& PlayerCharacterTable()
+{
+    // 列顺序必须和 CharacterField 一致
+    static const TableSchema table{
+        "player_character",
+        {"username"},
+        {"character_id", "level", "exp", "gold", "scene_id", "pos_x", "pos_y"},
+    };
+    return table;
+}
+
+const TableSchema& PlayerInventoryTable()
+{
+    static const TableSchema table{"player_inventory", {"username", "slot"}, {"item_id", "item_count"}};
+    return table;
+}
+
+const TableSchema& PlayerQuestTable()
+{
+    static const TableSchema table{"player_quest", {"username", "quest_id"}, {"state", "progress"}};
+    return table;
+}
+
+const TableSchema& PlayerFriendTable()
+{
+    static const TableSchema table{"player_friend", {"username", "friend_name"}, {"added_at"}};
+    return table;
+}
+
+const TableSchema* FindPlayerTable(const string& name)
+{
+    for (const TableSchema* table : {&PlayerCharacterTable(), &PlayerInventoryTable(), &PlayerQuestTable(),
+                                     &PlayerFriendTable()}) {
+        if (table->name == name) return table;
+    }
+    return nullptr;
+}
+
+RowImage ToRow(const PlayerCharacter& c)
+{
+    return RowImage{
+        &PlayerCharacterTable(),
+        {c.username},
+        {c.characterId, c.level, c.exp, c.gold, c.sceneId, c.posX, c.posY},
+        {}, // 整行
+    };
+}
+
+bool TrackedCharacter::takeDirtyRow(RowImage& out)
+{
+    static_assert(static_cast<size_t>(CharacterField::kCount) <= kMaxValueColumns, "too many character fields");
+    if (!unsaved_ && dirty_.none()) {
+        return false;
+    }
+    out = ToRow(data_);
+    if (!unsaved_) {
+        out.dirty = dirty_;
+    }
+    unsaved_ = false;
+    dirty_.reset();
+    return true;
+}
+
+void TrackedCharacter::restoreDirty(const RowImage& row)
+{
+    if (row.isPartial()) {
+        dirty_ |= row.dirty;
+    } else {
+        unsaved_ = true;
+    }
+}
+
+RowImage ToRow(const string& username, const InventoryItem& item)
+{
+    return RowImage{&PlayerInventoryTable(), {username, item.slot}, {item.itemId, item.count}, {}};
+}
+
+RowImage ToRow(const string& username, const QuestProgress& quest)
+{
+    return RowImage{&PlayerQuestTable(), {username, quest.questId}, {quest.state, quest.progress}, {}};
+}
+
+RowImage ToRow(const string& username, const FriendEntry& entry)
+{
+    return RowImage{&PlayerFriendTable(), {username, entry.name}, {entry.addedAt}, {}};
+}
@@ -0,0 +1,56 @@
+#ifndef PLAYER_LOAD_STAGE_H
+#define PLAYER_LOAD_STAGE_H
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <utility>
+#include "DBExecutor.h"
+#include "LogM.h"
+#include "PlayerLoader.h"
+
+/*
+    PlayerStorage::load 的并行阶段：MySQL 和内存实现都把四个阶段同时提交给执行器，
+    阶段在执行器线程上计时，调用方用 CollectStage 按同一个 deadline 取回
+*/
+template <typename R>
+struct StageResult {
+    R value{};
+    std::chrono::microseconds elapsed{0};
+};
+
+// 在执行器线程上调用 fn 并计时
+template <typename R, typename Fn>
+StageResult<R> RunStage(Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    StageResult<R> result;
+    result.value = fn();
+    result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return result;
+}
+
+// 等到 deadline 为止取结果；失败时把 status 降级（BUSY 优先于 FAILED 保留）
+template <typename R>
+void CollectStage(const char* stage, std::future<StageResult<R>>& f, std::chrono::steady_clock::time_point deadline,
+                  R& out, std::chrono::microseconds& elapsed, PlayerLoadStatus& status)
+{
+    if (f.wait_until(deadline) != std::future_status::ready) {
+        LOG_ERROR("Player load stage %s timed out", stage);
+        status = PlayerLoadStatus::BUSY;
+        return;
+    }
+    try {
+        StageResult<R> result = f.get();
+        out = std::move(result.value);
+        elapsed = result.elapsed;
+    } catch (const DBBusyError& e) {
+        LOG_ERROR("Player load stage %s: %s", stage, e.what());
+        status = PlayerLoadStatus::BUSY;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Player load stage %s failed: %s", stage, e.what());
+        if (status == PlayerLoadStatus::OK) status = PlayerLoadStatus::FAILED;
+    }
+}
+
+#endif // PLAYER_LOAD_STAGE_H
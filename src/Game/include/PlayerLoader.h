@@ -0,0 +1,95 @@
+#ifndef PLAYER_LOADER_H
+#define PLAYER_LOADER_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include "PlayerTables.h"
+#include "ShardedMap.h"
+
+class EventLoop;
+class WriteBehindStore;
+
+enum class PlayerLoadStatus {
+    OK,
+    BUSY,   // 执行器/连接池耗尽或加载超时，调用方应回 503
+    FAILED
+};
+
+// 各阶段是各自查询在 DB 线程上的执行时间，total 是登录线程等待的墙钟时间
+struct PlayerLoadTimings {
+    std::chrono::microseconds character{0};
+    std::chrono::microseconds inventory{0};
+    std::chrono::microseconds quests{0};
+    std::chrono::microseconds friends{0};
+    std::chrono::microseconds total{0};
+    bool resident = false; // 内存里已有，没有查库
+};
+
+/*
+    登录时经 GetPlayerStorage()（PlayerStorage.h）装配玩家数据：MySQL 实现把角色、背包、任务、好友
+    四条查询同时提交给 GetGameDBExecutor()，各自借一个池连接并行执行，总耗时约等于最慢的一条而不是四条之和
+    - 最多等 kPlayerLoadTimeout，超时返回 BUSY，不让登录线程无限挂住
+    - 没有角色行的新玩家用默认值建档，并写回 player_character
+    - 耗时导出到 /metrics：player_load_<阶段>_us、player_load_us
+    - 按 username 路由到 gamedb 分片，四条查询都读分片主库：装配出的 PlayerData 会被改动并写回，
+      从有延迟的副本读进来的旧数据会在下一次写回时覆盖主库
+*/
+constexpr std::chrono::milliseconds kPlayerLoadTimeout{3000};
+
+PlayerLoadStatus LoadPlayerData(const std::string& username, PlayerData& out, PlayerLoadTimings& timings);
+
+/*
+    在线玩家对象表：username -> PlayerData，登录 / 断线重连时 acquire，断线时 release
+    - 已在内存里（重连、顶号、刚下线）直接复用，内存对象比数据库新，不能重新查库覆盖
+    - 每 kSaveInterval 把在线玩家的脏字段交给写回存储（只含改过的列）
+    - release 时先交出最后的脏字段再做标记；等写回存储完成一次在 release 之后开始的成功 flush，
+      这名玩家的改动都已落库，sweep 才把对象丢掉，之后的登录重新查库不会读到旧数据
+    - 写回存储满了拒收时脏位留在对象上，玩家保持常驻，直到 saveDirty 交出去并等到下一次成功 flush
+*/
+class OnlinePlayers {
+public:
+    using Loader = std::function<PlayerLoadStatus(const std::string&, PlayerData&, PlayerLoadTimings&)>;
+
+    // 进程内用 getInstance()（GetPlayerStore() + LoadPlayerData）；单独构造用于注入假的存储和加载函数
+    OnlinePlayers(WriteBehindStore& store, Loader loader);
+    static OnlinePlayers& getInstance();
+
+    PlayerLoadStatus acquire(const std::string& username, std::shared_ptr<PlayerData>& out,
+                             PlayerLoadTimings* timings = nullptr);
+    // 会话建立之后调用，清掉旧连接断开时可能留下的 release 标记
+    void markOnline(const std::string& username, std::shared_ptr<PlayerData> data);
+    void release(const std::string& username);
+    std::shared_ptr<PlayerData> get(const std::string& username) const;
+
+    // 在 loop 上定时保存脏字段、清理已下线且已落库的玩家
+    void startSweep(EventLoop* loop);
+    size_t saveDirty();
+    size_t sweep();
+    // 退出钩子用：在 loop 线程上跑 saveDirty，写回存储拒收时先 flush 腾位置再交一次，最多等 timeout；
+    // 之后调用方再停写回存储和预写日志。loop 为空或已在 loop 线程时直接执行
+    size_t saveOnShutdown(EventLoop* loop, std::chrono::milliseconds timeout);
+    size_t size() const { return players_.size(); }
+
+private:
+    static constexpr std::chrono::seconds kSaveInterval{1};
+    static constexpr std::chrono::seconds kSweepInterval{10};
+
+    size_t saveAllDirty();
+
+    struct Resident {
+        std::shared_ptr<PlayerData> data;
+        bool released = false;
+        std::chrono::steady_clock::time_point releasedAt{};
+    };
+
+    OnlinePlayers(const OnlinePlayers&) = delete;
+    OnlinePlayers& operator=(const OnlinePlayers&) = delete;
+
+    WriteBehindStore& store_;
+    Loader loader_;
+    ShardedMap<std::string, Resident> players_;
+};
+
+#endif // PLAYER_LOADER_H
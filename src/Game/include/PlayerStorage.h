@@ -0,0 +1,35 @@
+#ifndef PLAYER_STORAGE_H
+#define PLAYER_STORAGE_H
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include "PlayerLoader.h"
+#include "PlayerTables.h"
+#include "WriteBehindStore.h"
+
+/*
+    玩家数据（gamedb 四张表）的存取接口，LoadPlayerData 和 GetPlayerStore() 都经过它
+    - MySQL 实现：按 username 路由到 gamedb 分片，四条查询并行提交给 GetGameDBExecutor()
+    - 内存实现：表放在 MemoryRowStore 里，四个阶段并行提交给 GetMemoryDBExecutor()，用于 GS_STORAGE=memory 的单机压测
+*/
+class PlayerStorage {
+public:
+    virtual ~PlayerStorage() = default;
+
+    // 查角色、背包、任务、好友，没有角色行时 character 为空；
+    // 填 timings 里各阶段的耗时（total 由调用方记），最多阻塞 kPlayerLoadTimeout
+    virtual PlayerLoadStatus load(const std::string& username, std::optional<PlayerCharacter>& character,
+                                  PlayerData& out, PlayerLoadTimings& timings) = 0;
+    // 写回存储（GetPlayerStore）落库用
+    virtual WriteBehindStore::BatchWriter writer() = 0;
+};
+
+std::unique_ptr<PlayerStorage> MakeMysqlPlayerStorage();
+std::unique_ptr<PlayerStorage> MakeMemoryPlayerStorage(std::chrono::microseconds latency);
+
+// 按 GS_STORAGE 选择实现，进程内唯一
+PlayerStorage& GetPlayerStorage();
+
+#endif // PLAYER_STORAGE_H
@@ -0,0 +1,167 @@
+#ifndef PLAYER_TABLES_H
+#define PLAYER_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DBRow.h"
+
+class RowLog;
+class WriteBehindStore;
+
+/*
+    gamedb 里的玩家数据表，玩家身份目前只有 username（登录时唯一确定），所有表主键以它开头
+        CREATE TABLE player_character (
+            username     VARCHAR(64) PRIMARY KEY,
+            character_id BIGINT NOT NULL,
+            level        BIGINT NOT NULL,
+            exp          BIGINT NOT NULL,
+            gold         BIGINT NOT NULL,
+            scene_id     BIGINT NOT NULL,
+            pos_x        DOUBLE NOT NULL,
+            pos_y        DOUBLE NOT NULL
+        );
+        CREATE TABLE player_inventory (
+            username   VARCHAR(64) NOT NULL,
+            slot       BIGINT NOT NULL,
+            item_id    BIGINT NOT NULL,
+            item_count BIGINT NOT NULL,
+            PRIMARY KEY (username, slot)
+        );
+        CREATE TABLE player_quest (
+            username VARCHAR(64) NOT NULL,
+            quest_id BIGINT NOT NULL,
+            state    BIGINT NOT NULL,
+            progress BIGINT NOT NULL,
+            PRIMARY KEY (username, quest_id)
+        );
+        CREATE TABLE player_friend (
+            username    VARCHAR(64) NOT NULL,
+            friend_name VARCHAR(64) NOT NULL,
+            added_at    BIGINT NOT NULL,   -- unix 秒
+            PRIMARY KEY (username, friend_name)
+        );
+*/
+struct PlayerCharacter {
+    std::string username;
+    int64_t characterId = 0;
+    int64_t level = 1;
+    int64_t exp = 0;
+    int64_t gold = 0;
+    int64_t sceneId = 0;
+    double posX = 0;
+    double posY = 0;
+};
+
+// player_character 的值列，顺序与 PlayerCharacterTable().valueColumns 一致
+enum class CharacterField : size_t {
+    CharacterId = 0,
+    Level,
+    Exp,
+    Gold,
+    SceneId,
+    PosX,
+    PosY,
+    kCount
+};
+
+/*
+    带字段脏位的角色：改字段只走 setter，值真的变了才置位；保存时 takeDirtyRow 只带出改过的列，
+    写回存储据此生成只含这些列的 UPDATE，不用每次整行重写
+        player->character.addGold(100);
+        RowImage row;
+        if (player->character.takeDirtyRow(row) && !GetPlayerStore().put(row)) player->character.restoreDirty(row);
+    - 写回存储拒收（背压）时必须 restoreDirty，否则这些改动就丢了
+    - 库里还没有行的新角色先 markUnsaved，下一次 takeDirtyRow 带出整行（upsert 建档），
+      建档成功之前的改动也都包含在这一整行里，不会变成影响 0 行的 UPDATE
+    不加锁，和 PlayerData 一样只在 loop 线程上改
+*/
+class TrackedCharacter {
+public:
+    TrackedCharacter() = default;
+    explicit TrackedCharacter(PlayerCharacter data) : data_(std::move(data)) {}
+
+    const PlayerCharacter& get() const { return data_; }
+    const ColumnMask& dirty() const { return dirty_; }
+
+    void setLevel(int64_t level) { assign(CharacterField::Level, data_.level, level); }
+    void setExp(int64_t exp) { assign(CharacterField::Exp, data_.exp, exp); }
+    void setGold(int64_t gold) { assign(CharacterField::Gold, data_.gold, gold); }
+    void addGold(int64_t delta) { setGold(data_.gold + delta); }
+    void setScene(int64_t sceneId) { assign(CharacterField::SceneId, data_.sceneId, sceneId); }
+    void setPosition(double x, double y) {
+        assign(CharacterField::PosX, data_.posX, x);
+        assign(CharacterField::PosY, data_.posY, y);
+    }
+
+    // 有脏列时生成部分列镜像（未建档时是整行）并清空脏位，没有改动返回 false
+    bool takeDirtyRow(RowImage& out);
+    // takeDirtyRow 取出的镜像没能交给写回存储：把脏位（整行则是未建档标记）放回去，下次再取
+    void restoreDirty(const RowImage& row);
+    void markUnsaved() { unsaved_ = true; }
+    bool hasUnsaved() const { return unsaved_ || dirty_.any(); }
+
+private:
+    template <typename T>
+    void assign(CharacterField field, T& slot, T value) {
+        if (slot == value) return;
+        slot = value;
+        dirty_.set(static_cast<size_t>(field));
+    }
+
+    PlayerCharacter data_;
+    ColumnMask dirty_;
+    bool unsaved_ = false; // 库里还没有这一行
+};
+
+struct InventoryItem {
+    int64_t slot = 0;
+    int64_t itemId = 0;
+    int64_t count = 0;
+};
+
+struct QuestProgress {
+    int64_t questId = 0;
+    int64_t state = 0;
+    int64_t progress = 0;
+};
+
+struct FriendEntry {
+    std::string name;
+    int64_t addedAt = 0;
+};
+
+// 登录时一次装配好的玩家内存对象，之后由 loop 线程读写，改动通过 GetPlayerStore() 写回
+struct PlayerData {
+    TrackedCharacter character;
+    std::vector<InventoryItem> inventory;
+    std::vector<QuestProgress> quests;
+    std::vector<FriendEntry> friends;
+};
+
+const TableSchema& PlayerCharacterTable();
+const TableSchema& PlayerInventoryTable();
+const TableSchema& PlayerQuestTable();
+const TableSchema& PlayerFriendTable();
+// 按表名找上面四张表，预写日志重放时用；不认识返回 nullptr
+const TableSchema* FindPlayerTable(const std::string& name);
+
+RowImage ToRow(const PlayerCharacter& character);
+RowImage ToRow(const std::string& username, const InventoryItem& item);
+RowImage ToRow(const std::string& username, const QuestProgress& quest);
+RowImage ToRow(const std::string& username, const FriendEntry& entry);
+
+// 玩家数据的写回存储，写入 GetPlayerStorage()（默认 gamedb）；刷新间隔由 GS_PLAYER_FLUSH_MS 配置（默认 5000）
+// 游戏逻辑改完状态后 put 最新镜像即可，不要在 loop 线程里直接写库
+WriteBehindStore& GetPlayerStore();
+
+// 写回存储前面的预写日志（RowLog.h），两次 flush 之间崩溃也不丢改动：
+// 目录 GS_PLAYER_WAL_DIR（默认 ./player_wal，设为 off 关闭），组提交间隔 GS_PLAYER_WAL_SYNC_MS（默认 10）
+// 关闭或目录不可用时返回 nullptr
+RowLog* GetPlayerLog();
+// 启动时、接受登录之前调用：把上次没落库的改动交回写回存储并同步 flush，返回重放的记录数
+size_t ReplayPlayerLog();
+
+#endif // PLAYER_TABLES_H
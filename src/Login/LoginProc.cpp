@@ -9,58 +9,120 @@
 #include "SafetyPwd.h"
 #include "QueryUserData.h"
 #include "GameRecvProc.h"
+#include "ResponseSink.h"
+#include "JsonWriter.h"
+#include "ResumeToken.h"
+#include "PlayerLoader.h"
 #include <memory>
 using namespace std;
 // 全局EventLoop实例 - 在实际项目中可能通过单例或依赖注入管理
 extern EventLoop* g_eventLoop;
 
-void BuildSession(HttpRequest& request, std::shared_ptr<Client> client, const std::string& token)
+void HandOverToEventLoop(std::shared_ptr<Client> client)
 {
-    // 这里可以创建会话信息，设置用户状态等
-    LOG_DEBUG("Building session for client fd=%d", client->getFd());
-    string key = "username";
-    UserSessionManager::getInstance().createSession(token, request.getParam(key), client->getFd());
     // 将认证成功的连接交给EventLoop管理
     // EventLoop会接管这个连接的后续读写事件
     // todo 未来会有多个EventLoop，通过负载均衡算法进行选择
     if (g_eventLoop) {
         // 关键：在移交给 EventLoop 之前，为该连接设置读回调（协议/业务处理）
         client->setReadCallback([](Client* c, const char* data, ssize_t len) {
+            // 收到消息即视为活跃，会话过期时间顺延
+            if (auto ses = UserSessionManager::getInstance().getSessionByConn(c->getConnId())) {
+                ses->touch();
+            }
             handleGameMessage(c, data, static_cast<size_t>(len));
         });
+        // 断线时立即清理会话和索引，不必等过期扫描；玩家对象等改动落库后再由 sweep 释放
+        client->setCloseCallback([](Client* c) {
+            auto& manager = UserSessionManager::getInstance();
+            if (auto ses = manager.getSessionByConn(c->getConnId())) {
+                if (ses->getConnId() == c->getConnId()) {
+                    OnlinePlayers::getInstance().release(ses->getUsername());
+                }
+            }
+            manager.onDisconnect(c->getConnId());
+        });
         g_eventLoop->addClient(client);
         LOG_DEBUG("Client fd=%d added to EventLoop", client->getFd());
     }
 }
 
-void SendLoginSuccessResponse(int client_fd, const std::string& token)
+void BuildSession(const std::string& username, std::shared_ptr<Client> client, const SessionToken& token,
+                  std::shared_ptr<PlayerData> player)
 {
-    nlohmann::json responseJson = {
-        {"status", "success"},
-        {"message", "Login successful"},
-        {"token", token}
-    };
-    
-    send_json_response(client_fd, 200, responseJson, true);
+    LOG_DEBUG("Building session for client fd=%d", client->getFd());
+    auto ses = UserSessionManager::getInstance().createSession(token, username, client->getFd(), client->getConnId());
+    const PlayerCharacter& character = player->character.get();
+    ses->setAttr(SessionAttr::CharacterId, character.characterId);
+    ses->setAttr(SessionAttr::Level, character.level);
+    ses->setAttr(SessionAttr::SceneId, character.sceneId);
+    OnlinePlayers::getInstance().markOnline(username, std::move(player));
+    HandOverToEventLoop(client);
+}
+
+void SendLoginSuccessResponse(std::shared_ptr<Client> client, const std::string& username, const SessionToken& token)
+{
+    // 登录成功是高频固定结构响应，走模板直接渲染，不构造 json DOM
+    static const JsonTemplate kLoginSuccess(
+        R"({"status":"success","message":"Login successful","token":"${}","resumeToken":"${}"})");
+
+    std::string resumeToken = issueResumeToken(username, token, UserSessionCB::kDefaultTtl);
+    char hex[SessionToken::kHexSize];
+    token.toHex(hex);
+    std::string body;
+    kLoginSuccess.render(body, {std::string_view(hex, sizeof(hex)), resumeToken});
+    ResponseSink(g_eventLoop, client).send(HttpResponseBuilder(200).keepAlive(true).build(body), true);
 }
 
 bool ProcLoginRequest(HttpRequest& request, std::shared_ptr<Client> client)
 {
-    int client_fd = client->getFd();
     string username = request.getParam("username");
     string password = request.getParam("password");
     
-    if (verifyPassword(password, queryUserPwd(username))) {
-        // ⚠️ 重要：先发送响应，再交给EventLoop
-        // 原因：交给EventLoop后，handle_client线程就结束了，
-        // 如果先addClient，可能EventLoop还没poll到，但响应还没发送
-        string token = generateToken(username);
-        SendLoginSuccessResponse(client_fd, token);
-        BuildSession(request, client, token);
+    string pwdHash;
+    UserQueryStatus queried = queryUserPwd(username, pwdHash);
+    if (queried == UserQueryStatus::BUSY) {
+        ResponseSink(g_eventLoop, client).sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr,
+                                                   {{"Retry-After", "1"}});
+        return false;
+    }
+    if (queried != UserQueryStatus::OK) {
+        ResponseSink(g_eventLoop, client).sendJson(500, {{"error", "Database error"}}, false);
+        return false;
+    }
+
+    bool matched = false;
+    PwdHashStatus status = verifyPasswordBounded(password, pwdHash, matched);
+    if (status == PwdHashStatus::OVERLOADED) {
+        ResponseSink(g_eventLoop, client).sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr,
+                                                   {{"Retry-After", "1"}});
+        return false;
+    }
+
+    if (status == PwdHashStatus::OK && matched) {
+        // 玩家数据在交给 EventLoop 之前装配好，之后的游戏消息直接读内存
+        std::shared_ptr<PlayerData> player;
+        PlayerLoadStatus loaded = OnlinePlayers::getInstance().acquire(username, player);
+        if (loaded == PlayerLoadStatus::BUSY) {
+            ResponseSink(g_eventLoop, client).sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr,
+                                                       {{"Retry-After", "1"}});
+            return false;
+        }
+        if (loaded != PlayerLoadStatus::OK) {
+            ResponseSink(g_eventLoop, client).sendJson(500, {{"error", "Failed to load player data"}}, false);
+            return false;
+        }
+
+        // 先交给EventLoop（设置好读回调），再发送响应：
+        // 连接归属 loop 之后，ResponseSink 会把响应投递到 loop 的写缓冲，
+        // 由 loop 线程负责写出，不会与后续的 sendToClient 交错，也不会阻塞当前线程
+        SessionToken token = generateToken();
+        BuildSession(username, client, token, std::move(player));
+        SendLoginSuccessResponse(client, username, token);
         return true; // 连接已交给EventLoop管理
     }
 
     // 发送失败响应给客户端
-    send_json_response(client_fd, 401, {{"error", "Invalid username or password"}}, false);
+    ResponseSink(g_eventLoop, client).sendJson(401, {{"error", "Invalid username or password"}}, false);
     return false; // 认证失败，连接应该关闭
 }
\ No newline at end of file
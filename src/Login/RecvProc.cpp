@@ -14,13 +14,17 @@
 #include "SafetyPwd.h"
 #include "Client.h"
 #include "ParseHttp.h"
-#include "ParseHttp.h"
+#include "HttpRouter.h"
+#include "ResponseSink.h"
+#include "EventLoop.h"
 #include "LoginProc.h"
 #include "SignUpProc.h"
+#include "ResumeProc.h"
 using namespace std;
 
+extern EventLoop* g_eventLoop;
 
-void handle_client(std::shared_ptr<Client> client)
+void handle_client(std::shared_ptr<Client> client, const HttpRouter& router)
 {
     int client_fd = client->getFd();
     LOG_DEBUG("Handling new client: fd=%d", client_fd);
@@ -42,12 +46,22 @@ void handle_client(std::shared_ptr<Client> client)
 
     // 处理请求
     bool keepConnection = false;
-    if (request.getPath() == "/api/login") {
-        keepConnection = ProcLoginRequest(request, client);
-    } else if (request.getPath() == "/api/register") {
-        keepConnection = ProcSignUpRequest(request, client);
-    } else {
+    const HttpRouter::Handler* handler = nullptr;
+    RouteParams params;
+    std::string allow;
+    switch (router.match(ParseHttpMethod(request.getMethod()), request.getPath(), handler, params, &allow)) {
+    case HttpRouter::MatchResult::Found:
+        keepConnection = (*handler)(request, client, params);
+        break;
+    case HttpRouter::MatchResult::MethodNotAllowed:
+        LOG_ERROR("Method %s not allowed on %s", request.getMethod().c_str(), request.getPath().c_str());
+        ResponseSink(g_eventLoop, client).sendJson(405, {{"error", "Method not allowed"}}, false, nullptr,
+                                                   {{"Allow", allow}});
+        break;
+    case HttpRouter::MatchResult::NotFound:
         LOG_ERROR("Unknown API endpoint: %s", request.getPath().c_str());
+        ResponseSink(g_eventLoop, client).sendJson(404, {{"error", "Not found"}}, false);
+        break;
     }
     
     /* 生命周期管理说明：
@@ -64,7 +78,33 @@ void handle_client(std::shared_ptr<Client> client)
     }
 }
 
+static const HttpRouter& LoginRouter()
+{
+    static const HttpRouter router = []() {
+        HttpRouter r;
+        r.addRoute(HttpMethod::POST, "/api/login",
+            [](HttpRequest& req, std::shared_ptr<Client> client, const RouteParams&) {
+                return ProcLoginRequest(req, client);
+            });
+        r.addRoute(HttpMethod::POST, "/api/register",
+            [](HttpRequest& req, std::shared_ptr<Client> client, const RouteParams&) {
+                return ProcSignUpRequest(req, client);
+            });
+        r.addRoute(HttpMethod::POST, "/api/resume",
+            [](HttpRequest& req, std::shared_ptr<Client> client, const RouteParams&) {
+                return ProcResumeRequest(req, client);
+            });
+        return r;
+    }();
+    return router;
+}
+
 int ProcLoginReq(int port)
+{
+    return ServeHttp(port, LoginRouter());
+}
+
+int ServeHttp(int port, const HttpRouter& router)
 {
     int server_fd = socket(AF_INET, SOCK_STREAM, 0);
     if (server_fd < 0) {
@@ -107,7 +147,7 @@ int ProcLoginReq(int port)
             continue;
         }
         auto client = std::make_shared<Client>(client_fd); // RAII 管理客户端连接
-        std::thread t(handle_client, client);
+        std::thread t(handle_client, client, std::cref(router));
         t.detach();
     }
     close(server_fd);
@@ -0,0 +1,80 @@
+#include "ResumeProc.h"
+#include "LoginProc.h"
+#include "LogM.h"
+#include "ResumeToken.h"
+#include "UserSessionCB.h"
+#include "ResponseSink.h"
+#include "EventLoop.h"
+#include "JsonWriter.h"
+#include "http_response.h"
+#include "PlayerLoader.h"
+#include <memory>
+using namespace std;
+
+extern EventLoop* g_eventLoop;
+
+bool ProcResumeRequest(HttpRequest& request, std::shared_ptr<Client> client)
+{
+    ResumeClaims claims;
+    if (!verifyResumeToken(string(request.getParamView("resumeToken")), claims)) {
+        ResponseSink(g_eventLoop, client).sendJson(401, {{"error", "Invalid or expired resume token"}}, false);
+        return false;
+    }
+
+    auto& manager = UserSessionManager::getInstance();
+    if (manager.isRevoked(claims.token)) {
+        // 会话被顶号或过期清理过，签名再有效也不能恢复
+        ResponseSink(g_eventLoop, client).sendJson(401, {{"error", "Invalid or expired resume token"}}, false);
+        return false;
+    }
+    auto session = manager.getSession(claims.token);
+    if (session && session->getUsername() != claims.username) {
+        LOG_ERROR("Resume token user mismatch for fd=%d", client->getFd());
+        ResponseSink(g_eventLoop, client).sendJson(401, {{"error", "Invalid or expired resume token"}}, false);
+        return false;
+    }
+    if (!session && manager.getSessionByUser(claims.username)) {
+        // 这个账号已经用别的 token 重新登录过，旧的续期令牌作废
+        ResponseSink(g_eventLoop, client).sendJson(409, {{"error", "Session replaced by a newer login"}}, false);
+        return false;
+    }
+
+    // 通常玩家对象还在内存里；服务重启或下线较久时重新从 gamedb 装配
+    std::shared_ptr<PlayerData> player;
+    PlayerLoadStatus loaded = OnlinePlayers::getInstance().acquire(claims.username, player);
+    if (loaded != PlayerLoadStatus::OK) {
+        if (loaded == PlayerLoadStatus::BUSY) {
+            ResponseSink(g_eventLoop, client).sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr,
+                                                       {{"Retry-After", "1"}});
+        } else {
+            ResponseSink(g_eventLoop, client).sendJson(500, {{"error", "Failed to load player data"}}, false);
+        }
+        return false;
+    }
+
+    if (session) {
+        // 网络抖动后的重连：会话还在，换绑到新连接
+        manager.rebindSession(session, client->getFd(), client->getConnId());
+        session->touch();
+        LOG_DEBUG("Resumed session for %s on fd=%d", claims.username.c_str(), client->getFd());
+    } else if (manager.resumeSession(claims.token, claims.username, client->getFd(), client->getConnId())) {
+        // 会话已随断线或重启清理，签名保证了身份，按原 token 重建
+        LOG_DEBUG("Recreated session for %s on fd=%d", claims.username.c_str(), client->getFd());
+    } else {
+        // 上面检查之后同一账号刚好又登录了：玩家对象归新会话使用，这里不 release
+        ResponseSink(g_eventLoop, client).sendJson(409, {{"error", "Session replaced by a newer login"}}, false);
+        return false;
+    }
+    OnlinePlayers::getInstance().markOnline(claims.username, std::move(player));
+    HandOverToEventLoop(client);
+
+    static const JsonTemplate kResumeSuccess(
+        R"({"status":"success","message":"Session resumed","token":"${}","resumeToken":"${}"})");
+    string resumeToken = issueResumeToken(claims.username, claims.token, UserSessionCB::kDefaultTtl);
+    char hex[SessionToken::kHexSize];
+    claims.token.toHex(hex);
+    string body;
+    kResumeSuccess.render(body, {string_view(hex, sizeof(hex)), resumeToken});
+    ResponseSink(g_eventLoop, client).send(HttpResponseBuilder(200).keepAlive(true).build(body), true);
+    return true;
+}
@@ -0,0 +1,275 @@
+#include "SessionSnapshot.h"
+#include "ShutdownHooks.h"
+#include "UserSessionCB.h"
+#include "ResumeToken.h"
+#include "LogM.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+constexpr char kMagic[4] = {'G', 'S', 'S', 'N'};
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 4 + 2 + 2 + 4 + 4 + 8 + kResumeKeySize;
+constexpr size_t kRecordFixedSize = SessionToken::kSize + 8 + 8 + 8 + 1;
+
+using TimePoint = UserSessionCB::TimePoint;
+
+struct SnapshotRecord {
+    SessionToken token;
+    string username;
+    int64_t createdAt;
+    int64_t lastAccessAt;
+    int64_t expireAt;
+};
+
+int64_t ToUnixMs(TimePoint tp)
+{
+    return chrono::duration_cast<chrono::milliseconds>(tp.time_since_epoch()).count();
+}
+
+TimePoint FromUnixMs(int64_t ms)
+{
+    return TimePoint(chrono::duration_cast<TimePoint::duration>(chrono::milliseconds(ms)));
+}
+
+void PutLE(unsigned char*& p, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        *p++ = static_cast<unsigned char>(v >> (8 * i));
+    }
+}
+
+uint64_t GetLE(const unsigned char*& p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= static_cast<uint64_t>(*p++) << (8 * i);
+    }
+    return v;
+}
+
+sigset_t ShutdownSignals()
+{
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    return set;
+}
+
+} // namespace
+
+string SessionSnapshotPath()
+{
+    const char* env = getenv("GS_SESSION_SNAPSHOT");
+    return (env && *env) ? env : "session.snap";
+}
+
+long SaveSessionSnapshot(const string& path)
+{
+    auto start = chrono::steady_clock::now();
+
+    // 1. 在分片读锁下只拷贝必要字段，文件 I/O 全部放在锁外
+    vector<SnapshotRecord> records;
+    size_t total = kHeaderSize;
+    UserSessionManager::getInstance().forEachSession([&records, &total](const shared_ptr<UserSessionCB>& ses) {
+        const string& username = ses->getUsername();
+        if (username.size() > 255) return;
+        records.push_back({ses->getToken(), username, ToUnixMs(ses->getCreatedAt()),
+                           ToUnixMs(ses->getLastAccessAt()), ToUnixMs(ses->getExpireAt())});
+        total += kRecordFixedSize + username.size();
+    });
+
+    // 2. 写临时文件：ftruncate 定长后 mmap，一次 memcpy 式顺序写入
+    string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("SaveSessionSnapshot open %s failed, errno=%d", tmpPath.c_str(), errno);
+        return -1;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        LOG_ERROR("SaveSessionSnapshot ftruncate failed, errno=%d", errno);
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return -1;
+    }
+    void* mem = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        LOG_ERROR("SaveSessionSnapshot mmap failed, errno=%d", errno);
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return -1;
+    }
+
+    unsigned char* p = static_cast<unsigned char*>(mem);
+    memcpy(p, kMagic, sizeof(kMagic));
+    p += sizeof(kMagic);
+    PutLE(p, kVersion, 2);
+    PutLE(p, 0, 2);
+    PutLE(p, records.size(), 4);
+    PutLE(p, 0, 4);
+    PutLE(p, static_cast<uint64_t>(ToUnixMs(UserSessionCB::Clock::now())), 8);
+    unsigned char key[kResumeKeySize];
+    getResumeKey(key);
+    memcpy(p, key, sizeof(key));
+    p += sizeof(key);
+
+    for (const auto& r : records) {
+        memcpy(p, r.token.bytes.data(), SessionToken::kSize);
+        p += SessionToken::kSize;
+        PutLE(p, static_cast<uint64_t>(r.createdAt), 8);
+        PutLE(p, static_cast<uint64_t>(r.lastAccessAt), 8);
+        PutLE(p, static_cast<uint64_t>(r.expireAt), 8);
+        PutLE(p, r.username.size(), 1);
+        memcpy(p, r.username.data(), r.username.size());
+        p += r.username.size();
+    }
+
+    // 3. 落盘后再 rename 覆盖旧快照
+    bool ok = ::msync(mem, total, MS_SYNC) == 0;
+    ::munmap(mem, total);
+    ::close(fd);
+    if (!ok || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("SaveSessionSnapshot commit %s failed, errno=%d", path.c_str(), errno);
+        ::unlink(tmpPath.c_str());
+        return -1;
+    }
+
+    auto costUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    LOG_INFO("Session snapshot saved: %zu sessions, %zu bytes, %lld us",
+             records.size(), total, (long long)costUs);
+    return static_cast<long>(records.size());
+}
+
+size_t LoadSessionSnapshot(const string& path)
+{
+    auto start = chrono::steady_clock::now();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            LOG_INFO("No session snapshot at %s, starting empty", path.c_str());
+        } else {
+            LOG_ERROR("LoadSessionSnapshot open %s failed, errno=%d", path.c_str(), errno);
+        }
+        return 0;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        LOG_ERROR("LoadSessionSnapshot %s too small or unreadable", path.c_str());
+        ::close(fd);
+        return 0;
+    }
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void* mem = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mem == MAP_FAILED) {
+        LOG_ERROR("LoadSessionSnapshot mmap failed, errno=%d", errno);
+        return 0;
+    }
+    ::madvise(mem, fileSize, MADV_SEQUENTIAL);
+
+    const unsigned char* begin = static_cast<const unsigned char*>(mem);
+    const unsigned char* end = begin + fileSize;
+    const unsigned char* p = begin;
+
+    size_t restored = 0;
+    size_t skipped = 0;
+    if (memcmp(p, kMagic, sizeof(kMagic)) != 0) {
+        LOG_ERROR("LoadSessionSnapshot %s bad magic", path.c_str());
+        ::munmap(mem, fileSize);
+        return 0;
+    }
+    p += sizeof(kMagic);
+    uint16_t version = static_cast<uint16_t>(GetLE(p, 2));
+    GetLE(p, 2);
+    uint32_t count = static_cast<uint32_t>(GetLE(p, 4));
+    GetLE(p, 4);
+    GetLE(p, 8); // savedAt，目前只用于排查
+    if (version != kVersion) {
+        LOG_ERROR("LoadSessionSnapshot %s unsupported version %u", path.c_str(), (unsigned)version);
+        ::munmap(mem, fileSize);
+        return 0;
+    }
+
+    // 恢复签名密钥：快照里的会话只有配上原来的密钥，客户端手里的 resumeToken 才能验签通过
+    unsigned char key[kResumeKeySize];
+    memcpy(key, p, sizeof(key));
+    p += sizeof(key);
+    setResumeKey(key);
+
+    auto& manager = UserSessionManager::getInstance();
+    auto now = UserSessionCB::Clock::now();
+    for (uint32_t i = 0; i < count; ++i) {
+        if (static_cast<size_t>(end - p) < kRecordFixedSize) {
+            LOG_ERROR("LoadSessionSnapshot %s truncated at record %u", path.c_str(), i);
+            break;
+        }
+        SessionToken token;
+        memcpy(token.bytes.data(), p, SessionToken::kSize);
+        p += SessionToken::kSize;
+        TimePoint createdAt = FromUnixMs(static_cast<int64_t>(GetLE(p, 8)));
+        TimePoint lastAccessAt = FromUnixMs(static_cast<int64_t>(GetLE(p, 8)));
+        TimePoint expireAt = FromUnixMs(static_cast<int64_t>(GetLE(p, 8)));
+        size_t userLen = static_cast<size_t>(GetLE(p, 1));
+        if (static_cast<size_t>(end - p) < userLen) {
+            LOG_ERROR("LoadSessionSnapshot %s truncated at record %u", path.c_str(), i);
+            break;
+        }
+        string username(reinterpret_cast<const char*>(p), userLen);
+        p += userLen;
+
+        if (expireAt <= now || !manager.restoreSession(token, username, createdAt, lastAccessAt, expireAt)) {
+            ++skipped;
+            continue;
+        }
+        ++restored;
+    }
+    ::munmap(mem, fileSize);
+
+    auto costUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    LOG_INFO("Session snapshot loaded: %zu restored, %zu skipped, %lld us",
+             restored, skipped, (long long)costUs);
+    return restored;
+}
+
+void BlockShutdownSignals()
+{
+    sigset_t set = ShutdownSignals();
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+void StartSessionSnapshotter(const string& path, chrono::seconds interval)
+{
+    thread([path, interval]() {
+        sigset_t set = ShutdownSignals();
+        timespec timeout{};
+        timeout.tv_sec = static_cast<time_t>(interval.count());
+        while (true) {
+            int sig = ::sigtimedwait(&set, nullptr, &timeout);
+            if (sig < 0) {
+                // 超时（EAGAIN）或被打断（EINTR）：按周期写一次
+                if (errno == EAGAIN) SaveSessionSnapshot(path);
+                continue;
+            }
+            LOG_INFO("Received signal %d, running shutdown hooks and saving session snapshot", sig);
+            RunShutdownHooks();
+            SaveSessionSnapshot(path);
+            // 其他线程仍在运行，不走静态析构，直接退出
+            std::_Exit(0);
+        }
+    }).detach();
+}
@@ -2,8 +2,12 @@
 #include "QueryUserData.h"
 #include "SafetyPwd.h"
 #include "http_response.h"
+#include "ResponseSink.h"
+#include "EventLoop.h"
 using namespace std;
 
+extern EventLoop* g_eventLoop;
+
 bool VerifyInvCode(const std::string& invCode)
 {
     // 简单的邀请码验证逻辑
@@ -13,27 +17,57 @@ bool VerifyInvCode(const std::string& invCode)
 
 bool ProcSignUpRequest(HttpRequest &request, std::shared_ptr<Client> client)
 {
-    int client_fd = client->getFd();
+    ResponseSink sink(g_eventLoop, client);
     string username = request.getParam("username");
     string password = request.getParam("password");
     string InvCode = request.getParam("invCode");
 
     if (!VerifyInvCode(InvCode)) {
         // 发送失败响应给客户端
-        send_json_response(client_fd, 401, {{"error", "Invalid invitation code"}}, false);
+        sink.sendJson(401, {{"error", "Invalid invitation code"}}, false);
         return false; // 认证失败，连接应该关闭
     }
 
-    if (IsUserExists(username)) {
+    // 布隆过滤器说“一定没被占用”时不查库，直接 INSERT，唯一键冲突兜底
+    bool exists = false;
+    UserQueryStatus queried = UsernameMightExist(username) ? IsUserExists(username, exists) : UserQueryStatus::OK;
+    if (queried == UserQueryStatus::BUSY) {
+        sink.sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr, {{"Retry-After", "1"}});
+        return false;
+    }
+    if (queried != UserQueryStatus::OK) {
+        sink.sendJson(500, {{"error", "Database error"}}, false);
+        return false;
+    }
+    if (exists) {
         // 发送失败响应给客户端
-        send_json_response(client_fd, 409, {{"error", "User already exists"}}, false);
+        sink.sendJson(409, {{"error", "User already exists"}}, false);
         return false; // 认证失败，连接应该关闭
     }
 
-    if (!InsertUserInfo(username, hashPassword(password), InvCode)) {
+    string pwdHash;
+    PwdHashStatus status = hashPasswordBounded(password, pwdHash);
+    if (status == PwdHashStatus::OVERLOADED) {
+        sink.sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr, {{"Retry-After", "1"}});
+        return false;
+    }
+
+    InsertUserStatus inserted = status == PwdHashStatus::OK
+        ? InsertUserInfo(username, pwdHash, InvCode) : InsertUserStatus::DB_ERROR;
+    if (inserted == InsertUserStatus::DUPLICATE) {
+        sink.sendJson(409, {{"error", "User already exists"}}, false);
+        return false;
+    }
+    if (inserted == InsertUserStatus::BUSY) {
+        sink.sendJson(503, {{"error", "Server busy, please retry"}}, false, nullptr, {{"Retry-After", "1"}});
+        return false;
+    }
+    if (inserted != InsertUserStatus::OK) {
         // 发送失败响应给客户端
-        send_json_response(client_fd, 500, {{"error", "Database error"}}, false);
+        sink.sendJson(500, {{"error", "Database error"}}, false);
         return false; // 认证失败，连接应该关闭
     }
-    return true;
+
+    sink.sendJson(200, {{"status", "success"}, {"message", "Register successful"}}, false);
+    return false; // 注册是短连接，客户端随后走 /api/login
 }
\ No newline at end of file
@@ -1,17 +1,33 @@
 #include "UserSessionCB.h"
 #include <memory>
-#include <sstream>
 #include "LogM.h"
 #include "EventLoop.h"
 #include "Client.h"
 #include "json.hpp"
+#include "http_response.h"
+#include "JsonWriter.h"
+#include "Metrics.h"
 // 前置声明并使用全局 EventLoop 指针
 using namespace std;
 using json = nlohmann::json;
 extern EventLoop* g_eventLoop;
 
-UserSessionCB::UserSessionCB(const std::string& token, const std::string& username, int clientFd)
-        : clientFd_(clientFd)
+namespace {
+
+// 距离过期还要转几格时间轮，向上取整，至少 1 格
+uint64_t TicksUntil(UserSessionCB::TimePoint expireAt, UserSessionCB::TimePoint now,
+                    std::chrono::seconds tick)
+{
+    if (expireAt <= now) return 1;
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(expireAt - now);
+    auto tickMs = std::chrono::duration_cast<std::chrono::milliseconds>(tick);
+    return static_cast<uint64_t>((left.count() + tickMs.count() - 1) / tickMs.count());
+}
+
+} // namespace
+
+UserSessionCB::UserSessionCB(const SessionToken& token, const std::string& username, int clientFd, uint64_t connId)
+        : clientFd_(clientFd), connId_(connId)
 {
     std::scoped_lock lk(mu_);
     data_.token = token;
@@ -19,17 +35,34 @@ UserSessionCB::UserSessionCB(const std::string& token, const std::string& userna
     auto now = Clock::now();
     data_.createdAt = now;
     data_.lastAccessAt = now;
-    data_.expireAt = now + std::chrono::hours(1); // 默认1小时过期
+    data_.expireAt = now + kDefaultTtl; // 默认1小时过期
 }
 
 bool UserSessionCB::isExpired(TimePoint now) const
 {
+    std::scoped_lock lk(mu_);
     return now >= data_.expireAt;
 }
 
 void UserSessionCB::touch(TimePoint now) {
     std::scoped_lock lk(mu_);
     data_.lastAccessAt = now;
+    data_.expireAt = now + kDefaultTtl; // 时间轮到期时会看到新的 expireAt，重新挂上去
+}
+
+void UserSessionCB::restoreTimes(TimePoint createdAt, TimePoint lastAccessAt, TimePoint expireAt)
+{
+    std::scoped_lock lk(mu_);
+    data_.createdAt = createdAt;
+    data_.lastAccessAt = lastAccessAt;
+    data_.expireAt = expireAt;
+}
+
+void UserSessionCB::rebindClient(int clientFd, uint64_t connId)
+{
+    std::scoped_lock lk(mu_);
+    clientFd_ = clientFd;
+    connId_ = connId;
 }
 
 UserSessionManager& UserSessionManager::getInstance()
@@ -38,82 +71,278 @@ UserSessionManager& UserSessionManager::getInstance()
     return instance;
 }
 
-UserSessionManager::UserSessionManager()
+void UserSessionManager::startExpiry(EventLoop* loop)
+{
+    EventLoop* expected = nullptr;
+    if (!expiryLoop_.compare_exchange_strong(expected, loop)) {
+        LOG_ERROR("UserSessionManager::startExpiry called twice");
+        return;
+    }
+    loop->runEvery(kExpiryTick, [this]() { onExpiryTick(); });
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::createSession(const SessionToken& token,
+                                                const std::string& username,
+                                                int clientFd,
+                                                uint64_t connId)
 {
-    thread([this]() {
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::minutes(5));
-            auditSessions();
+    auto ses = std::make_shared<UserSessionCB>(token, username, clientFd, connId);
+    sessions_.insertOrAssign(token, ses);
+    byConn_.insertOrAssign(connId, token);
+
+    // 同名用户只保留最新会话：索引先指向新 token，再清理旧会话；
+    // 换索引和取旧 token 在同一把分片锁里，并发登录时每个旧会话只会被一个调用方换下来清理
+    SessionToken oldToken;
+    bool hadOld = byUser_.exchange(username, token, oldToken) && oldToken != token;
+    scheduleExpiry(ses);
+    if (hadOld) {
+        std::shared_ptr<UserSessionCB> old;
+        if (sessions_.find(oldToken, old) && sessions_.eraseIf(oldToken, [&old](const std::shared_ptr<UserSessionCB>& cur) {
+                return cur == old;
+            })) {
+            revokeToken(oldToken);
+            uint64_t oldConn = old->getConnId();
+            byConn_.eraseIf(oldConn, [&oldToken](const SessionToken& t) { return t == oldToken; });
+            LOG_INFO("Session replaced by new login, username=%s oldConn=%llu",
+                     username.c_str(), (unsigned long long)oldConn);
+            if (oldConn != connId) {
+                closeSessionConn(old, buildSessionReplacedResponse(oldToken));
+            }
         }
-    }).detach();
+    }
+
+    ++sessionCounter_;
+    return ses;
 }
 
-std::shared_ptr<UserSessionCB> UserSessionManager::createSession(const std::string& token,
+std::shared_ptr<UserSessionCB> UserSessionManager::resumeSession(const SessionToken& token,
                                                 const std::string& username,
-                                                int clientFd)
+                                                int clientFd,
+                                                uint64_t connId)
 {
-    std::lock_guard<std::mutex> lk(mu_);
-    auto ses = std::make_shared<UserSessionCB>(token, username, clientFd);
-    sessions_[token] = ses;
+    // 先占 byUser_ 再查吊销：过期清理是先吊销再删索引，占到索引之后一定能看到吊销记录
+    if (!byUser_.insert(username, token)) return nullptr;
+    if (isRevoked(token)) {
+        byUser_.eraseIf(username, [&token](const SessionToken& t) { return t == token; });
+        return nullptr;
+    }
+
+    auto ses = std::make_shared<UserSessionCB>(token, username, clientFd, connId);
+    sessions_.insertOrAssign(token, ses);
+    byConn_.insertOrAssign(connId, token);
+    scheduleExpiry(ses);
     ++sessionCounter_;
     return ses;
 }
 
-std::shared_ptr<UserSessionCB> UserSessionManager::getSession(const std::string& token)
+bool UserSessionManager::isRevoked(const SessionToken& token) const
 {
-    std::lock_guard<std::mutex> lk(mu_);
-    auto it = sessions_.find(token);
-    if (it != sessions_.end()) return it->second;
-    return nullptr;
+    TimePoint until;
+    return revoked_.find(token, until) && UserSessionCB::Clock::now() < until;
 }
 
-void UserSessionManager::auditSessions()
+void UserSessionManager::revokeToken(const SessionToken& token)
 {
-    std::scoped_lock lk(mu_);
+    revoked_.insertOrAssign(token, UserSessionCB::Clock::now() + UserSessionCB::kDefaultTtl);
+}
+
+void UserSessionManager::pruneRevoked(TimePoint now)
+{
+    size_t shard = revokedPruneShard_++ % revoked_.shardCount();
+    revoked_.eraseIfInShard(shard, [now](const SessionToken&, const TimePoint& until) { return until <= now; });
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::restoreSession(const SessionToken& token,
+                                                const std::string& username,
+                                                TimePoint createdAt,
+                                                TimePoint lastAccessAt,
+                                                TimePoint expireAt)
+{
+    // 启动阶段还没有连接进来，直接写入即可；快照里同名用户只应有一条，重复的丢弃
+    if (!byUser_.insert(username, token)) return nullptr;
+
+    auto ses = std::make_shared<UserSessionCB>(token, username, -1, 0);
+    ses->restoreTimes(createdAt, lastAccessAt, expireAt);
+    sessions_.insertOrAssign(token, ses);
+    scheduleExpiry(ses);
+    ++sessionCounter_;
+    return ses;
+}
+
+void UserSessionManager::forEachSession(const std::function<void(const std::shared_ptr<UserSessionCB>&)>& fn) const
+{
+    for (size_t shard = 0; shard < SessionTable::shardCount(); ++shard) {
+        sessions_.forEachInShard(shard, [&fn](const SessionToken&, const std::shared_ptr<UserSessionCB>& ses) {
+            fn(ses);
+        });
+    }
+}
+
+void UserSessionManager::rebindSession(const std::shared_ptr<UserSessionCB>& ses, int clientFd, uint64_t connId)
+{
+    const SessionToken& token = ses->getToken();
+    uint64_t oldConn = ses->getConnId();
+    ses->rebindClient(clientFd, connId);
+    byConn_.eraseIf(oldConn, [&token](const SessionToken& t) { return t == token; });
+    byConn_.insertOrAssign(connId, token);
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::getSession(const SessionToken& token)
+{
+    std::shared_ptr<UserSessionCB> ses;
+    sessions_.find(token, ses);
+    return ses;
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::getSession(std::string_view hexToken)
+{
+    SessionToken token;
+    if (!SessionToken::fromHex(hexToken, token)) return nullptr;
+    return getSession(token);
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::getSessionByUser(const std::string& username)
+{
+    SessionToken token;
+    if (!byUser_.find(username, token)) return nullptr;
+    return getSession(token);
+}
+
+std::shared_ptr<UserSessionCB> UserSessionManager::getSessionByConn(uint64_t connId)
+{
+    SessionToken token;
+    if (!byConn_.find(connId, token)) return nullptr;
+    return getSession(token);
+}
+
+bool UserSessionManager::sendToUser(const std::string& username, std::string data)
+{
+    auto ses = getSessionByUser(username);
+    if (!ses || !g_eventLoop) return false;
+
+    int clientFd = ses->getClientFd();
+    uint64_t connId = ses->getConnId();
+    g_eventLoop->runInLoop([clientFd, connId, data = std::move(data)]() mutable {
+        auto client = g_eventLoop->getClient(clientFd);
+        if (!client || client->getConnId() != connId) return; // 连接已断开或 fd 已被复用
+        g_eventLoop->sendToClient(clientFd, std::move(data));
+    });
+    return true;
+}
+
+void UserSessionManager::onDisconnect(uint64_t connId)
+{
+    SessionToken token;
+    if (!byConn_.find(connId, token)) return;
+
+    std::shared_ptr<UserSessionCB> ses;
+    if (!sessions_.find(token, ses) || ses->getConnId() != connId) {
+        // 会话已换绑到别的连接（resume），只清掉这条连接的索引
+        byConn_.eraseIf(connId, [&token](const SessionToken& t) { return t == token; });
+        return;
+    }
+    removeSession(ses);
+    LOG_DEBUG("Session removed on disconnect, username=%s conn=%llu",
+              ses->getUsername().c_str(), (unsigned long long)connId);
+}
+
+void UserSessionManager::removeSession(const std::shared_ptr<UserSessionCB>& ses)
+{
+    const SessionToken& token = ses->getToken();
+    sessions_.eraseIf(token, [&ses](const std::shared_ptr<UserSessionCB>& cur) { return cur == ses; });
+    removeIndexes(ses);
+}
+
+void UserSessionManager::removeIndexes(const std::shared_ptr<UserSessionCB>& ses)
+{
+    const SessionToken& token = ses->getToken();
+    auto sameToken = [&token](const SessionToken& t) { return t == token; };
+    byUser_.eraseIf(ses->getUsername(), sameToken);
+    byConn_.eraseIf(ses->getConnId(), sameToken);
+}
+
+void UserSessionManager::closeSessionConn(const std::shared_ptr<UserSessionCB>& ses, std::string notice)
+{
+    if (!g_eventLoop) return;
+
+    int clientFd = ses->getClientFd();
+    uint64_t connId = ses->getConnId();
+    g_eventLoop->runInLoop([clientFd, connId, notice = std::move(notice)]() mutable {
+        auto client = g_eventLoop->getClient(clientFd);
+        if (!client || client->getConnId() != connId) return; // 连接已断开或 fd 已被复用
+        g_eventLoop->sendAndClose(clientFd, std::move(notice));
+    });
+    LOG_DEBUG("Scheduled session close notice for fd=%d conn=%llu", clientFd, (unsigned long long)connId);
+}
+
+void UserSessionManager::scheduleExpiry(const std::shared_ptr<UserSessionCB>& ses)
+{
+    EventLoop* loop = expiryLoop_.load(std::memory_order_acquire);
+    if (!loop) return;
+
+    uint64_t ticks = TicksUntil(ses->getExpireAt(), UserSessionCB::Clock::now(), kExpiryTick);
+    loop->runInLoop([this, weak = std::weak_ptr<UserSessionCB>(ses), ticks]() mutable {
+        expiryWheel_.add(std::move(weak), ticks);
+    });
+}
+
+void UserSessionManager::onExpiryTick()
+{
+    static auto& expiredTotal = MetricsRegistry::getInstance().counter(
+        "session_expired_total", "Sessions removed by idle expiry");
+    static auto& backlog = MetricsRegistry::getInstance().gauge(
+        "session_expiry_backlog", "Expired sessions waiting for a later wheel tick");
+
     auto now = UserSessionCB::Clock::now();
-    for (auto it = sessions_.begin(); it != sessions_.end(); ) {
-        if (it->second->isExpired(now)) {
-            LOG_INFO("Auditing: removing expired session token=%s", it->first.c_str());
-            
-            if (g_eventLoop) {
-                int clientFd = it->second->getClientFd();
-                
-                // 构造会话过期通知响应
-                std::string expireNotice = buildSessionExpiredResponse(it->first);
-                
-                // 使用便捷函数：发送并关闭连接
-                g_eventLoop->sendAndClose(clientFd, expireNotice);
-                
-                LOG_DEBUG("Scheduled session expiry notice for fd=%d", clientFd);
+    expiryWheel_.tick(kMaxExpirePerTick, [this, now](std::weak_ptr<UserSessionCB>& weak) {
+        auto ses = weak.lock();
+        if (!ses) return; // 已经因断线、重复登录被移除
+
+        const SessionToken& token = ses->getToken();
+        bool removed = sessions_.eraseIf(token, [&ses, now](const std::shared_ptr<UserSessionCB>& cur) {
+            return cur == ses && cur->isExpired(now);
+        });
+        if (!removed) {
+            // 被 touch 续期过：按新的过期时间重新挂上去；已不在表里的直接丢弃
+            if (getSession(token) == ses) {
+                expiryWheel_.add(std::move(weak), TicksUntil(ses->getExpireAt(), now, kExpiryTick));
             }
-            
-            // 从会话列表中移除
-            it = sessions_.erase(it);
-        } else {
-            ++it;
+            return;
         }
-    }
+
+        LOG_INFO("Session expired, username=%s token=%s", ses->getUsername().c_str(), token.toHex().c_str());
+        revokeToken(token);
+        removeIndexes(ses);
+        closeSessionConn(ses, buildSessionExpiredResponse(token));
+        expiredTotal.inc();
+    });
+    backlog.set(static_cast<int64_t>(expiryWheel_.backlog()));
+    pruneRevoked(now);
 }
 
 // 构造会话过期通知的 HTTP 响应
-std::string UserSessionManager::buildSessionExpiredResponse(const std::string& token)
+std::string UserSessionManager::buildSessionExpiredResponse(const SessionToken& token)
 {
-    // 构造 JSON 响应体
-    json responseBody;
-    responseBody["error"] = "session_expired";
-    responseBody["message"] = "Your session has expired. Please login again.";
-    responseBody["token"] = token;
-    
-    std::string jsonStr = responseBody.dump();
-    
-    // 构造完整的 HTTP 响应
-    std::ostringstream response;
-    response << "HTTP/1.1 401 Unauthorized\r\n";
-    response << "Content-Type: application/json\r\n";
-    response << "Content-Length: " << jsonStr.length() << "\r\n";
-    response << "Connection: close\r\n"; // 发送后关闭连接
-    response << "\r\n";
-    response << jsonStr;
+    // 构造 JSON 响应体（固定结构，模板渲染）
+    static const JsonTemplate kSessionExpired(
+        R"({"error":"session_expired","message":"Your session has expired. Please login again.","token":"${}"})");
+
+    char hex[SessionToken::kHexSize];
+    token.toHex(hex);
+    std::string jsonStr = kSessionExpired.render({std::string_view(hex, sizeof(hex))});
     
-    return response.str();
+    // 构造完整的 HTTP 响应，发送后关闭连接
+    return HttpResponseBuilder(401).contentType(ContentType::JSON).keepAlive(false).build(jsonStr);
+}
+
+// 同一账号在别处登录，旧连接收到的通知
+std::string UserSessionManager::buildSessionReplacedResponse(const SessionToken& token)
+{
+    static const JsonTemplate kSessionReplaced(
+        R"({"error":"session_replaced","message":"Your account has logged in elsewhere.","token":"${}"})");
+
+    char hex[SessionToken::kHexSize];
+    token.toHex(hex);
+    std::string jsonStr = kSessionReplaced.render({std::string_view(hex, sizeof(hex))});
+    return HttpResponseBuilder(409).contentType(ContentType::JSON).keepAlive(false).build(jsonStr);
 }
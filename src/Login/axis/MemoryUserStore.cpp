@@ -0,0 +1,46 @@
+#include "MemoryUserStore.h"
+#include <thread>
+
+using namespace std;
+
+MemoryUserStore::MemoryUserStore(chrono::microseconds latency) : latency_(latency)
+{
+}
+
+void MemoryUserStore::delay() const
+{
+    if (latency_.count() > 0) {
+        this_thread::sleep_for(latency_);
+    }
+}
+
+UserQueryStatus MemoryUserStore::find(const string& username, CachedUserInfo& info)
+{
+    delay();
+    Record record;
+    info.exists = users_.find(username, record);
+    info.pwdHash = info.exists ? record.pwdHash : "";
+    return UserQueryStatus::OK;
+}
+
+InsertUserStatus MemoryUserStore::insert(const string& username, const string& pwdHash,
+                                         const string& invCode, int64_t signUpTime)
+{
+    delay();
+    return users_.insert(username, Record{pwdHash, invCode, signUpTime}) ? InsertUserStatus::OK
+                                                                         : InsertUserStatus::DUPLICATE;
+}
+
+bool MemoryUserStore::countUsers(size_t& count)
+{
+    count = users_.size();
+    return true;
+}
+
+bool MemoryUserStore::forEachUsername(const function<void(const string&)>& fn)
+{
+    for (size_t shard = 0; shard < users_.shardCount(); ++shard) {
+        users_.forEachInShard(shard, [&fn](const string& username, const Record&) { fn(username); });
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef MEMORY_USER_STORE_H
+#define MEMORY_USER_STORE_H
+
+#include <chrono>
+#include "ShardedMap.h"
+#include "UserStore.h"
+
+// sys_user 的内存实现：username -> 记录的分片哈希表，insert 在分片锁内判重，语义同唯一键；
+// 每次操作先 sleep latency 模拟数据库往返
+class MemoryUserStore : public UserStore {
+public:
+    explicit MemoryUserStore(std::chrono::microseconds latency = std::chrono::microseconds(0));
+
+    UserQueryStatus find(const std::string& username, CachedUserInfo& info) override;
+    InsertUserStatus insert(const std::string& username, const std::string& pwdHash,
+                            const std::string& invCode, int64_t signUpTime) override;
+    bool countUsers(size_t& count) override;
+    bool forEachUsername(const std::function<void(const std::string&)>& fn) override;
+
+private:
+    struct Record {
+        std::string pwdHash;
+        std::string invCode;
+        int64_t signUpTime = 0;
+    };
+
+    void delay() const;
+
+    std::chrono::microseconds latency_;
+    ShardedMap<std::string, Record> users_;
+};
+
+#endif // MEMORY_USER_STORE_H
@@ -0,0 +1,123 @@
+#include "UserStore.h"
+#include "DBConnPool.h"
+#include "LogM.h"
+#include <memory>
+
+namespace {
+
+constexpr int kMysqlDupEntry = 1062; // ER_DUP_ENTRY
+
+class MysqlUserStore : public UserStore {
+public:
+    UserQueryStatus find(const std::string& username, CachedUserInfo& info) override;
+    InsertUserStatus insert(const std::string& username, const std::string& pwdHash,
+                            const std::string& invCode, int64_t signUpTime) override;
+    bool countUsers(size_t& count) override;
+    bool forEachUsername(const std::function<void(const std::string&)>& fn) override;
+};
+
+UserQueryStatus MysqlUserStore::find(const std::string& username, CachedUserInfo& info)
+{
+    ConnectionPoolAgent dbAgent(&GetUserDBPool());
+    if (!dbAgent) {
+        LOG_ERROR("Failed to get database connection");
+        return dbAgent.status() == CheckoutStatus::TIMEOUT ? UserQueryStatus::BUSY : UserQueryStatus::DB_ERROR;
+    }
+    
+    try {
+        sql::PreparedStatement* pstmt = dbAgent.prepare(
+            "SELECT password_hash FROM sys_user WHERE username = ?"
+        );
+        pstmt->setString(1, username);
+        std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
+        info.exists = resultSet->next();
+        info.pwdHash = info.exists ? resultSet->getString("password_hash") : "";
+        return UserQueryStatus::OK;
+    } catch (const std::exception& e) {
+        // 处理异常，例如记录日志
+        LOG_ERROR("Database query error: %s", e.what());
+        return UserQueryStatus::DB_ERROR;
+    }
+}
+
+InsertUserStatus MysqlUserStore::insert(const std::string& username, const std::string& pwdHash,
+                                        const std::string& invCode, int64_t signUpTime)
+{
+    ConnectionPoolAgent dbAgent(&GetUserDBPool());
+    if (!dbAgent) {
+        LOG_ERROR("Failed to get database connection");
+        return dbAgent.status() == CheckoutStatus::TIMEOUT ? InsertUserStatus::BUSY : InsertUserStatus::DB_ERROR;
+    }
+    
+    try {
+        sql::PreparedStatement* pstmt = dbAgent.prepare(
+            "INSERT INTO sys_user (username, password_hash, inv_code, signUp_time) VALUES (?, ?, ?, ?)"
+        );
+        pstmt->setString(1, username);
+        pstmt->setString(2, pwdHash);
+        pstmt->setString(3, invCode);
+        pstmt->setString(4, std::to_string(signUpTime));
+        int affectedRows = pstmt->executeUpdate();
+        return affectedRows > 0 ? InsertUserStatus::OK : InsertUserStatus::DB_ERROR;
+    } catch (const sql::SQLException& e) {
+        if (e.getErrorCode() == kMysqlDupEntry) {
+            // username 唯一键冲突：用户已存在，以数据库为准
+            return InsertUserStatus::DUPLICATE;
+        }
+        LOG_ERROR("Database insert error: %s (code %d)", e.what(), e.getErrorCode());
+        return InsertUserStatus::DB_ERROR;
+    } catch (const std::exception& e) {
+        // 处理异常，例如记录日志
+        LOG_ERROR("Database insert error: %s", e.what());
+        return InsertUserStatus::DB_ERROR;
+    }
+}
+
+bool MysqlUserStore::countUsers(size_t& count)
+{
+    ConnectionPoolAgent dbAgent(&GetUserDBPool());
+    if (!dbAgent) {
+        LOG_ERROR("Failed to get database connection");
+        return false;
+    }
+    try {
+        std::unique_ptr<sql::PreparedStatement> countStmt(
+            dbAgent->prepareStatement("SELECT COUNT(*) FROM sys_user")
+        );
+        std::unique_ptr<sql::ResultSet> countRs(countStmt->executeQuery());
+        count = countRs->next() ? static_cast<size_t>(countRs->getInt64(1)) : 0;
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Database query error: %s", e.what());
+        return false;
+    }
+}
+
+bool MysqlUserStore::forEachUsername(const std::function<void(const std::string&)>& fn)
+{
+    ConnectionPoolAgent dbAgent(&GetUserDBPool());
+    if (!dbAgent) {
+        LOG_ERROR("Failed to get database connection");
+        return false;
+    }
+    try {
+        std::unique_ptr<sql::PreparedStatement> pstmt(
+            dbAgent->prepareStatement("SELECT username FROM sys_user")
+        );
+        std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
+        while (resultSet->next()) {
+            fn(std::string(resultSet->getString(1)));
+        }
+        return true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Database query error: %s", e.what());
+        return false;
+    }
+}
+
+} // namespace
+
+std::unique_ptr<UserStore> MakeMysqlUserStore()
+{
+    return std::make_unique<MysqlUserStore>();
+}
@@ -0,0 +1,89 @@
+#include "PwdHashPool.h"
+#include "Metrics.h"
+#include "LogM.h"
+#include <sodium.h>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+static size_t PwHashMemBudget()
+{
+    const char* env = getenv("GS_PWHASH_MEM_MB");
+    size_t mb = env ? static_cast<size_t>(strtoul(env, nullptr, 10)) : 0;
+    return (mb > 0 ? mb : 512) * 1024 * 1024;
+}
+
+PwdHashPool& PwdHashPool::getInstance()
+{
+    static PwdHashPool instance;
+    return instance;
+}
+
+PwdHashPool::PwdHashPool()
+{
+    size_t cores = max<size_t>(1, thread::hardware_concurrency());
+    size_t byMemory = max<size_t>(1, PwHashMemBudget() / crypto_pwhash_MEMLIMIT_INTERACTIVE);
+    size_t threads = min(cores, byMemory);
+    // 每个线程最多排 8 个，按一次 verify 约 50ms 估算，排队最长约 400ms
+    queueCapacity_ = threads * 8;
+
+    LOG_INFO("PwdHashPool threads=%zu queueCapacity=%zu", threads, queueCapacity_);
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+PwdHashPool::~PwdHashPool()
+{
+    {
+        lock_guard<mutex> lk(mu_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : workers_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+bool PwdHashPool::trySubmit(function<void()> job)
+{
+    static auto& rejected = MetricsRegistry::getInstance().counter(
+        "pwhash_rejected_total", "Password hash jobs rejected because the queue was full");
+    static auto& depth = MetricsRegistry::getInstance().gauge(
+        "pwhash_queue_depth", "Password hash jobs waiting for a worker");
+
+    {
+        lock_guard<mutex> lk(mu_);
+        if (stopping_ || jobs_.size() >= queueCapacity_) {
+            rejected.inc();
+            return false;
+        }
+        jobs_.push_back(std::move(job));
+        depth.set(static_cast<int64_t>(jobs_.size()));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void PwdHashPool::workerLoop()
+{
+    static auto& depth = MetricsRegistry::getInstance().gauge("pwhash_queue_depth");
+    while (true) {
+        function<void()> job;
+        {
+            unique_lock<mutex> lk(mu_);
+            cv_.wait(lk, [this]() { return stopping_ || !jobs_.empty(); });
+            if (stopping_ && jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            depth.set(static_cast<int64_t>(jobs_.size()));
+        }
+        try {
+            job();
+        } catch (const exception& e) {
+            LOG_ERROR("PwdHashPool job failed: %s", e.what());
+        }
+    }
+}
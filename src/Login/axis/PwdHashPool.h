@@ -0,0 +1,45 @@
+#ifndef PWD_HASH_POOL_H
+#define PWD_HASH_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    Argon2 专用线程池：
+    crypto_pwhash 在 INTERACTIVE 参数下每次占用约 64MB 内存，
+    线程数 = min(CPU 核数, 内存预算 / 单次内存)，排队长度有上限，
+    队列满时 trySubmit 直接返回 false，调用方应回 503 + Retry-After，而不是无限堆积
+    内存预算默认 512MB，可通过环境变量 GS_PWHASH_MEM_MB 调整
+*/
+class PwdHashPool {
+public:
+    static PwdHashPool& getInstance();
+
+    // 返回 false 表示过载，job 不会被执行
+    bool trySubmit(std::function<void()> job);
+
+    size_t threadCount() const { return workers_.size(); }
+    size_t queueCapacity() const { return queueCapacity_; }
+
+private:
+    PwdHashPool();
+    ~PwdHashPool();
+    PwdHashPool(const PwdHashPool&) = delete;
+    PwdHashPool& operator=(const PwdHashPool&) = delete;
+
+    void workerLoop();
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> jobs_;
+    size_t queueCapacity_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+#endif // PWD_HASH_POOL_H
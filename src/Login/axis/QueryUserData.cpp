@@ -1,89 +1,123 @@
 #include "QueryUserData.h"
-#include "DBConnPool.h"
 #include "LogM.h"
+#include "UserInfoCache.h"
+#include "UserStore.h"
+#include "MemoryUserStore.h"
+#include "StorageBackend.h"
+#include "BloomFilter.h"
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <chrono>
-std::string queryUserPwd(const std::string &username)
+
+namespace {
+
+constexpr size_t kMinFilterItems = 1 << 20;
+
+// 加载完成前为空，此时 UsernameMightExist 一律返回 true，退回到查库
+std::shared_ptr<BloomFilter>& UsernameFilter()
 {
-    ConnectionPoolAgent dbAgent(&GetUserDBPool());
-    if (!dbAgent) {
-        LOG_ERROR("Failed to get database connection");
-        return "";
+    static std::shared_ptr<BloomFilter> filter;
+    return filter;
+}
+
+void AddUsernameToFilter(const std::string& username)
+{
+    auto filter = std::atomic_load(&UsernameFilter());
+    if (filter) {
+        filter->add(username); // 位数组是原子的，可以和查询并发
     }
-    
-    try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            dbAgent->prepareStatement(
-                "SELECT password_hash FROM sys_user WHERE username = ?"
-            )
-        );
-        pstmt->setString(1, username);
-        std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
-        if (resultSet->next()) {
-            return resultSet->getString("password_hash");
-        } else {
-            return ""; // 用户不存在
+}
+
+} // namespace
+
+UserStore& GetUserStore()
+{
+    static std::unique_ptr<UserStore> store = []() -> std::unique_ptr<UserStore> {
+        if (ConfiguredStorage() == StorageKind::MEMORY) {
+            LOG_INFO("sys_user kept in memory (GS_STORAGE=memory)");
+            return std::make_unique<MemoryUserStore>(MemoryStoreLatency());
         }
-    } catch (const std::exception& e) {
-        // 处理异常，例如记录日志
-        LOG_ERROR("Database query error: %s", e.what());
-        return "";
-    }
+        return MakeMysqlUserStore();
+    }();
+    return *store;
 }
 
-bool IsUserExists(const std::string &username)
+// 先查缓存，未命中再查库并回填；密码查询和存在性检查共用同一条缓存
+static UserQueryStatus GetUserInfo(const std::string& username, CachedUserInfo& info)
 {
-    ConnectionPoolAgent dbAgent(&GetUserDBPool());
-    if (!dbAgent) {
-        LOG_ERROR("Failed to get database connection");
-        return false;
+    auto& cache = UserInfoCache::getInstance();
+    if (cache.get(username, info)) {
+        return UserQueryStatus::OK;
     }
-    
-    try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            dbAgent->prepareStatement(
-                "SELECT 1 FROM sys_user WHERE username = ?"
-            )
-        );
-        pstmt->setString(1, username);
-        std::unique_ptr<sql::ResultSet> resultSet(pstmt->executeQuery());
-        return resultSet->next();
-    } catch (const std::exception& e) {
-        // 处理异常，例如记录日志
-        LOG_ERROR("Database query error: %s", e.what());
-        return false;
+    uint64_t ticket = cache.loadTicket(username);
+    UserQueryStatus status = GetUserStore().find(username, info);
+    if (status == UserQueryStatus::OK) {
+        cache.put(username, info, ticket);
     }
+    return status;
+}
+
+UserQueryStatus queryUserPwd(const std::string &username, std::string& pwdHash)
+{
+    CachedUserInfo info;
+    UserQueryStatus status = GetUserInfo(username, info);
+    pwdHash = info.pwdHash; // 用户不存在或出错时为空
+    return status;
 }
 
-bool InsertUserInfo(const std::string& username, const std::string pwd, const std::string invCode)
+UserQueryStatus IsUserExists(const std::string &username, bool& exists)
+{
+    CachedUserInfo info;
+    UserQueryStatus status = GetUserInfo(username, info);
+    exists = info.exists;
+    return status;
+}
+
+InsertUserStatus InsertUserInfo(const std::string& username, const std::string pwd, const std::string invCode)
 {
     auto now = std::chrono::system_clock::now();
-    std::string nowStr = std::to_string(
-        std::chrono::duration_cast<std::chrono::seconds>(
-            now.time_since_epoch()
-        ).count()
-    );
-    ConnectionPoolAgent dbAgent(&GetUserDBPool());
-    if (!dbAgent) {
-        LOG_ERROR("Failed to get database connection");
+    int64_t signUpTime = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+    InsertUserStatus status = GetUserStore().insert(username, pwd, invCode, signUpTime);
+    // 成功后旧的负缓存已过时；失败时库里的状态不确定，同样丢掉
+    UserInfoCache::getInstance().invalidate(username);
+    if (status == InsertUserStatus::OK || status == InsertUserStatus::DUPLICATE) {
+        // 唯一键冲突说明用户已存在，以存储为准
+        AddUsernameToFilter(username);
+    }
+    return status;
+}
+
+bool LoadUsernameFilter()
+{
+    auto& store = GetUserStore();
+    auto start = std::chrono::steady_clock::now();
+    size_t rows = 0;
+    if (!store.countUsers(rows)) {
         return false;
     }
-    
-    try {
-        std::unique_ptr<sql::PreparedStatement> pstmt(
-            dbAgent->prepareStatement(
-                "INSERT INTO sys_user (username, password_hash, inv_code, signUp_time) VALUES (?, ?, ?, ?)"
-            )
-        );
-        pstmt->setString(1, username);
-        pstmt->setString(2, pwd);
-        pstmt->setString(3, invCode);
-        pstmt->setString(4, nowStr);
-        int affectedRows = pstmt->executeUpdate();
-        return affectedRows > 0;
-    } catch (const std::exception& e) {
-        // 处理异常，例如记录日志
-        LOG_ERROR("Database insert error: %s", e.what());
+
+    // 留出两倍余量给之后的注册，误判率 1%
+    auto filter = std::make_shared<BloomFilter>(std::max<size_t>(rows * 2, kMinFilterItems), 0.01);
+    size_t loaded = 0;
+    bool ok = store.forEachUsername([&filter, &loaded](const std::string& username) {
+        filter->add(username);
+        ++loaded;
+    });
+    if (!ok) {
         return false;
     }
+    std::atomic_store(&UsernameFilter(), filter);
+
+    auto costMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("Username filter loaded: %zu names, %zu bits, k=%zu, %lld ms",
+             loaded, filter->bitCount(), filter->hashCount(), (long long)costMs);
+    return true;
+}
+
+bool UsernameMightExist(const std::string& username)
+{
+    auto filter = std::atomic_load(&UsernameFilter());
+    return !filter || filter->mightContain(username);
 }
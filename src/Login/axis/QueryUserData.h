@@ -2,8 +2,15 @@
 #define QUERY_USER_DATA_H
 
 #include <string>
+#include "UserStore.h"
 
-std::string queryUserPwd(const std::string& username);
-bool IsUserExists(const std::string& username);
-bool InsertUserInfo(const std::string& username, const std::string pwd, const std::string invCode);
+// 用户不存在时返回 OK，pwdHash 为空 / exists 为 false
+UserQueryStatus queryUserPwd(const std::string& username, std::string& pwdHash);
+UserQueryStatus IsUserExists(const std::string& username, bool& exists);
+InsertUserStatus InsertUserInfo(const std::string& username, const std::string pwd, const std::string invCode);
+
+// 用户名布隆过滤器：启动时从 sys_user 全量加载，之后注册成功时增量加入
+// UsernameMightExist 返回 false 表示用户名一定没被占用，可以跳过 IsUserExists 直接 INSERT
+bool LoadUsernameFilter();
+bool UsernameMightExist(const std::string& username);
 #endif // QUERY_USER_DATA_H
\ No newline at end of file
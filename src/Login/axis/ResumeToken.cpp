@@ -0,0 +1,101 @@
+#include "ResumeToken.h"
+#include "LogM.h"
+#include <sodium.h>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+constexpr uint8_t kResumeTokenVersion = 2;
+
+static_assert(kResumeKeySize == crypto_auth_KEYBYTES, "resume key size mismatch");
+
+unsigned char* ResumeKey()
+{
+    static unsigned char key[crypto_auth_KEYBYTES];
+    static once_flag once;
+    call_once(once, []() { crypto_auth_keygen(key); });
+    return key;
+}
+
+int64_t NowSeconds()
+{
+    return chrono::duration_cast<chrono::seconds>(
+        chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void getResumeKey(unsigned char (&out)[kResumeKeySize])
+{
+    std::copy(ResumeKey(), ResumeKey() + kResumeKeySize, out);
+}
+
+void setResumeKey(const unsigned char (&key)[kResumeKeySize])
+{
+    std::copy(key, key + kResumeKeySize, ResumeKey());
+}
+
+string issueResumeToken(const string& username, const SessionToken& token, chrono::seconds ttl)
+{
+    if (username.size() > 255) {
+        LOG_ERROR("issueResumeToken field too long");
+        return "";
+    }
+
+    vector<unsigned char> buf;
+    buf.reserve(1 + 8 + SessionToken::kSize + 1 + username.size() + crypto_auth_BYTES);
+    buf.push_back(kResumeTokenVersion);
+    uint64_t expireAt = static_cast<uint64_t>(NowSeconds() + ttl.count());
+    for (int i = 0; i < 8; ++i) {
+        buf.push_back(static_cast<unsigned char>(expireAt >> (8 * i)));
+    }
+    buf.insert(buf.end(), token.bytes.begin(), token.bytes.end());
+    buf.push_back(static_cast<unsigned char>(username.size()));
+    buf.insert(buf.end(), username.begin(), username.end());
+
+    size_t payloadLen = buf.size();
+    buf.resize(payloadLen + crypto_auth_BYTES);
+    crypto_auth(buf.data() + payloadLen, buf.data(), payloadLen, ResumeKey());
+
+    string hex(buf.size() * 2 + 1, '\0');
+    sodium_bin2hex(&hex[0], hex.size(), buf.data(), buf.size());
+    hex.pop_back();
+    return hex;
+}
+
+bool verifyResumeToken(const string& wire, ResumeClaims& claims)
+{
+    vector<unsigned char> buf(wire.size() / 2);
+    size_t binLen = 0;
+    if (wire.empty() || wire.size() % 2 != 0 ||
+        sodium_hex2bin(buf.data(), buf.size(), wire.data(), wire.size(), nullptr, &binLen, nullptr) != 0 ||
+        binLen < 1 + 8 + SessionToken::kSize + 1 + crypto_auth_BYTES) {
+        return false;
+    }
+
+    size_t payloadLen = binLen - crypto_auth_BYTES;
+    if (crypto_auth_verify(buf.data() + payloadLen, buf.data(), payloadLen, ResumeKey()) != 0) {
+        LOG_INFO("Resume token signature mismatch");
+        return false;
+    }
+
+    // 签名通过后再解析，长度字段仍要做边界检查
+    size_t pos = 0;
+    if (buf[pos++] != kResumeTokenVersion) return false;
+    uint64_t expireAt = 0;
+    for (int i = 0; i < 8; ++i) {
+        expireAt |= static_cast<uint64_t>(buf[pos++]) << (8 * i);
+    }
+    std::copy(buf.begin() + pos, buf.begin() + pos + SessionToken::kSize, claims.token.bytes.begin());
+    pos += SessionToken::kSize;
+    size_t userLen = buf[pos++];
+    if (pos + userLen != payloadLen) return false;
+    claims.username.assign(reinterpret_cast<const char*>(&buf[pos]), userLen);
+    claims.expireAt = static_cast<int64_t>(expireAt);
+
+    return claims.expireAt > NowSeconds();
+}
@@ -0,0 +1,31 @@
+#ifndef RESUME_TOKEN_H
+#define RESUME_TOKEN_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SessionToken.h"
+
+/*
+    断线重连用的续期令牌：payload + crypto_auth(HMAC-SHA512-256) 签名，hex 编码后下发给客户端
+    payload = version(1) | expireAt(8, 秒) | token(16) | usernameLen(1) | username
+    服务端只需验签 + 检查过期时间即可确认身份，不查库、不跑 Argon2
+    签名密钥进程启动时随机生成，重启后旧令牌失效（除非通过 setResumeKey 恢复）
+*/
+struct ResumeClaims {
+    std::string username;
+    SessionToken token;
+    int64_t expireAt = 0; // unix 秒
+};
+
+std::string issueResumeToken(const std::string& username, const SessionToken& token,
+                             std::chrono::seconds ttl);
+bool verifyResumeToken(const std::string& wire, ResumeClaims& claims);
+
+// 签名密钥的导出/恢复，供会话快照使用；setResumeKey 只能在开始签发令牌之前调用
+constexpr size_t kResumeKeySize = 32; // crypto_auth_KEYBYTES
+void getResumeKey(unsigned char (&out)[kResumeKeySize]);
+void setResumeKey(const unsigned char (&key)[kResumeKeySize]);
+
+#endif // RESUME_TOKEN_H
@@ -1,13 +1,14 @@
 #include "SafetyPwd.h"
+#include "PwdHashPool.h"
+#include "Metrics.h"
+#include "LogM.h"
 
 #include <sodium.h>
 #include <string>
 #include <stdexcept>
 #include <chrono>
-#include <atomic>
-#include <random>
-#include <sstream>
-#include <iomanip>
+#include <future>
+#include <memory>
 std::string hashPassword(const std::string& password)
 {
     char hash[crypto_pwhash_STRBYTES];
@@ -35,34 +36,54 @@ bool verifyPassword(const std::string& password, const std::string& storedHash)
            ) == 0;
 }
 
-std::string generateToken(const std::string& username)
+// 在 PwdHashPool 上执行 fn 并等待结果；记录排队等待与计算耗时
+template <typename T, typename Fn>
+static PwdHashStatus RunOnHashPool(Fn fn, T& result)
 {
-    using namespace std::chrono;
+    using Clock = std::chrono::steady_clock;
+    static auto& waitHist = MetricsRegistry::getInstance().histogram(
+        "pwhash_queue_wait_us", "Time password hash jobs spend queued before a worker picks them up");
+    static auto& hashHist = MetricsRegistry::getInstance().histogram(
+        "pwhash_duration_us", "Time spent inside crypto_pwhash");
 
-    // 1) 微秒级时间戳
-    uint64_t ts = duration_cast<microseconds>(
-        system_clock::now().time_since_epoch()
-    ).count();
-
-    // 2) 进程内单调递增计数器（保证同一微秒内也不重复）
-    static std::atomic<uint64_t> counter{0};
-    uint64_t c = counter.fetch_add(1, std::memory_order_relaxed);
+    auto task = std::make_shared<std::packaged_task<T()>>([fn, enqueued = Clock::now()]() {
+        auto start = Clock::now();
+        waitHist.observe(start - enqueued);
+        T r = fn();
+        hashHist.observe(Clock::now() - start);
+        return r;
+    });
+    std::future<T> fut = task->get_future();
+    if (!PwdHashPool::getInstance().trySubmit([task]() { (*task)(); })) {
+        LOG_INFO("PwdHashPool overloaded, rejecting request");
+        return PwdHashStatus::OVERLOADED;
+    }
 
-    // 3) 少量随机扰动（让外观更“散”）
-    static thread_local std::mt19937_64 rng{std::random_device{}()};
-    uint64_t r = rng();
+    try {
+        result = fut.get();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Password hash job failed: %s", e.what());
+        return PwdHashStatus::FAILED;
+    }
+    return PwdHashStatus::OK;
+}
 
-    // 4) 组合后转 hex
-    // 可把 username 混进去（不影响唯一性，只是区分度更明显）
-    std::ostringstream oss;
-    oss << std::hex << std::setw(16) << std::setfill('0') << ts
-        << std::setw(16) << std::setfill('0') << c
-        << std::setw(16) << std::setfill('0') << r;
+PwdHashStatus verifyPasswordBounded(const std::string& password, const std::string& storedHash, bool& matched)
+{
+    matched = false;
+    if (storedHash.empty()) {
+        return PwdHashStatus::OK; // 用户不存在，不占用哈希线程
+    }
+    return RunOnHashPool([password, storedHash]() { return verifyPassword(password, storedHash); }, matched);
+}
 
-    // 如果你希望 token 和用户名有关联，可再附加一个简短hash
-    // 这里用 std::hash 做轻量混合（不保证安全，只加特征）
-    size_t u = std::hash<std::string>{}(username);
-    oss << std::setw(sizeof(size_t)*2) << std::setfill('0') << u;
+PwdHashStatus hashPasswordBounded(const std::string& password, std::string& hash)
+{
+    return RunOnHashPool([password]() { return hashPassword(password); }, hash);
+}
 
-    return oss.str();
+SessionToken generateToken()
+{
+    // 128 位 CSPRNG 随机数，协议上再 hex 编码
+    return SessionToken::generate();
 }
\ No newline at end of file
@@ -2,8 +2,18 @@
 #define SAFETYPWD_H
 
 #include <string>
+#include "SessionToken.h"
 
 std::string hashPassword(const std::string& password);
 bool verifyPassword(const std::string& password, const std::string& storedHash) ;
-std::string generateToken(const std::string& username);
+SessionToken generateToken();
+
+// 经 PwdHashPool 限流的版本：OVERLOADED 表示排队已满，调用方应回 503 + Retry-After
+enum class PwdHashStatus {
+    OK,
+    OVERLOADED,
+    FAILED
+};
+PwdHashStatus verifyPasswordBounded(const std::string& password, const std::string& storedHash, bool& matched);
+PwdHashStatus hashPasswordBounded(const std::string& password, std::string& hash);
 #endif // SAFETYPWD_H
\ No newline at end of file
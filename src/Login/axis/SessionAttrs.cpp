@@ -0,0 +1,104 @@
+#include "SessionAttrs.h"
+#include <mutex>
+#include <unordered_map>
+
+using namespace std;
+
+namespace {
+
+constexpr const char* kBuiltinNames[] = {
+    "character_id",
+    "server_id",
+    "scene_id",
+    "level",
+    "is_gm",
+    "client_version",
+};
+static_assert(sizeof(kBuiltinNames) / sizeof(kBuiltinNames[0]) ==
+              static_cast<size_t>(SessionAttr::kBuiltinCount), "builtin attr names out of sync");
+
+struct Registry {
+    mutex mu;
+    unordered_map<string, uint16_t> ids;
+    vector<string> names;
+
+    Registry() {
+        for (const char* name : kBuiltinNames) {
+            ids.emplace(name, static_cast<uint16_t>(names.size()));
+            names.emplace_back(name);
+        }
+    }
+};
+
+Registry& GetRegistry()
+{
+    static Registry registry;
+    return registry;
+}
+
+} // namespace
+
+AttrKey SessionAttrRegistry::intern(string_view name)
+{
+    Registry& r = GetRegistry();
+    lock_guard<mutex> lk(r.mu);
+    auto it = r.ids.find(string(name));
+    if (it != r.ids.end()) {
+        return AttrKey(it->second);
+    }
+    uint16_t id = static_cast<uint16_t>(r.names.size());
+    r.ids.emplace(string(name), id);
+    r.names.emplace_back(name);
+    return AttrKey(id);
+}
+
+string SessionAttrRegistry::name(AttrKey key)
+{
+    Registry& r = GetRegistry();
+    lock_guard<mutex> lk(r.mu);
+    return key.id < r.names.size() ? r.names[key.id] : string();
+}
+
+const SessionAttrs::Value* SessionAttrs::findValue(AttrKey key) const
+{
+    for (size_t i = 0; i < inlineCount_; ++i) {
+        if (inline_[i].key == key.id) return &inline_[i].value;
+    }
+    for (const auto& e : overflow_) {
+        if (e.key == key.id) return &e.value;
+    }
+    return nullptr;
+}
+
+void SessionAttrs::append(AttrKey key, Value value)
+{
+    if (inlineCount_ < kInlineCapacity) {
+        inline_[inlineCount_].key = key.id;
+        inline_[inlineCount_].value = std::move(value);
+        ++inlineCount_;
+        return;
+    }
+    overflow_.push_back(Entry{key.id, std::move(value)});
+}
+
+bool SessionAttrs::erase(AttrKey key)
+{
+    for (size_t i = 0; i < inlineCount_; ++i) {
+        if (inline_[i].key != key.id) continue;
+        // 用最后一个有效元素填洞，保持前 inlineCount_ 个连续
+        if (i + 1 != inlineCount_) inline_[i] = std::move(inline_[inlineCount_ - 1]);
+        inline_[--inlineCount_].value = Value();
+        if (!overflow_.empty()) {
+            inline_[inlineCount_++] = std::move(overflow_.back());
+            overflow_.pop_back();
+        }
+        return true;
+    }
+    for (size_t i = 0; i < overflow_.size(); ++i) {
+        if (overflow_[i].key != key.id) continue;
+        if (i + 1 != overflow_.size()) overflow_[i] = std::move(overflow_.back());
+        overflow_.pop_back();
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,108 @@
+#ifndef SESSION_ATTRS_H
+#define SESSION_ATTRS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+// 编译期已知的会话属性，编号即 AttrKey::id
+enum class SessionAttr : uint16_t {
+    CharacterId = 0,
+    ServerId,
+    SceneId,
+    Level,
+    IsGm,
+    ClientVersion,
+    kBuiltinCount
+};
+
+struct AttrKey {
+    uint16_t id;
+
+    constexpr AttrKey(SessionAttr attr) : id(static_cast<uint16_t>(attr)) {}
+    constexpr explicit AttrKey(uint16_t rawId) : id(rawId) {}
+    constexpr bool operator==(AttrKey other) const { return id == other.id; }
+    constexpr bool operator!=(AttrKey other) const { return id != other.id; }
+};
+
+/*
+    运行时属性名 -> AttrKey 的驻留表，进程内编号固定不变，从 kBuiltinCount 开始分配
+    intern 要加锁，调用方应把结果缓存下来：
+        static const AttrKey kGuildId = SessionAttrRegistry::intern("guild_id");
+*/
+class SessionAttrRegistry {
+public:
+    static AttrKey intern(std::string_view name);
+    static std::string name(AttrKey key); // 调试/日志用，未知编号返回空串
+};
+
+/*
+    会话属性的小型扁平数组：按 AttrKey 线性查找，前 kInlineCapacity 个直接放在对象里，
+    数值类属性的读写既不哈希字符串也不分配内存；超出后才落到 overflow_
+    不加锁，由 UserSessionCB 的互斥量保护
+*/
+class SessionAttrs {
+public:
+    using Value = std::variant<int64_t, double, bool, std::string>;
+    static constexpr size_t kInlineCapacity = 8;
+
+    template <typename T>
+    const T* find(AttrKey key) const {
+        const Value* v = findValue(key);
+        return v ? std::get_if<T>(v) : nullptr;
+    }
+
+    // 存在且类型匹配才返回 true
+    template <typename T>
+    bool get(AttrKey key, T& out) const {
+        const T* v = find<T>(key);
+        if (!v) return false;
+        out = *v;
+        return true;
+    }
+
+    template <typename T>
+    void set(AttrKey key, T&& value) {
+        using Decayed = std::decay_t<T>;
+        // 整数统一存成 int64_t，字符串字面量存成 std::string
+        using Stored = std::conditional_t<std::is_same_v<Decayed, bool>, bool,
+                       std::conditional_t<std::is_integral_v<Decayed>, int64_t,
+                       std::conditional_t<std::is_floating_point_v<Decayed>, double, std::string>>>;
+        Value* v = findValue(key);
+        if (v) {
+            if (Stored* cur = std::get_if<Stored>(v)) {
+                *cur = Stored(std::forward<T>(value)); // 同类型原地覆盖，string 可复用已有容量
+            } else {
+                *v = Stored(std::forward<T>(value));
+            }
+            return;
+        }
+        append(key, Value(Stored(std::forward<T>(value))));
+    }
+
+    bool erase(AttrKey key);
+    size_t size() const { return inlineCount_ + overflow_.size(); }
+
+private:
+    struct Entry {
+        uint16_t key = 0;
+        Value value;
+    };
+
+    const Value* findValue(AttrKey key) const;
+    Value* findValue(AttrKey key) {
+        return const_cast<Value*>(static_cast<const SessionAttrs*>(this)->findValue(key));
+    }
+    void append(AttrKey key, Value value);
+
+    std::array<Entry, kInlineCapacity> inline_{};
+    size_t inlineCount_ = 0;
+    std::vector<Entry> overflow_;
+};
+
+#endif // SESSION_ATTRS_H
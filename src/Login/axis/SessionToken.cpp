@@ -0,0 +1,47 @@
+#include "SessionToken.h"
+#include <sodium.h>
+
+SessionToken SessionToken::generate()
+{
+    SessionToken t;
+    randombytes_buf(t.bytes.data(), t.bytes.size());
+    return t;
+}
+
+void SessionToken::toHex(char out[kHexSize]) const
+{
+    static const char kHex[] = "0123456789abcdef";
+    for (size_t i = 0; i < kSize; ++i) {
+        out[2 * i] = kHex[bytes[i] >> 4];
+        out[2 * i + 1] = kHex[bytes[i] & 0xF];
+    }
+}
+
+std::string SessionToken::toHex() const
+{
+    std::string s(kHexSize, '\0');
+    toHex(&s[0]);
+    return s;
+}
+
+bool SessionToken::fromHex(std::string_view hex, SessionToken& out)
+{
+    if (hex.size() != kHexSize) {
+        return false;
+    }
+    auto nibble = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    for (size_t i = 0; i < kSize; ++i) {
+        int hi = nibble(hex[2 * i]);
+        int lo = nibble(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out.bytes[i] = static_cast<uint8_t>((hi << 4) | lo);
+    }
+    return true;
+}
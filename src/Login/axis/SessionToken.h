@@ -0,0 +1,39 @@
+#ifndef SESSION_TOKEN_H
+#define SESSION_TOKEN_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+/*
+    128 位随机会话令牌（libsodium randombytes），内存里是定长 POD，只在协议上 hex 编码
+    - 生成与比较都不分配内存，可以直接当 unordered_map 的键
+    - 内容本身是均匀随机数，哈希直接取前 8 字节即可
+*/
+struct SessionToken {
+    static constexpr size_t kSize = 16;
+    static constexpr size_t kHexSize = kSize * 2;
+
+    std::array<uint8_t, kSize> bytes{};
+
+    static SessionToken generate();
+    static bool fromHex(std::string_view hex, SessionToken& out);
+
+    void toHex(char out[kHexSize]) const;
+    std::string toHex() const;
+
+    bool operator==(const SessionToken& other) const { return bytes == other.bytes; }
+    bool operator!=(const SessionToken& other) const { return bytes != other.bytes; }
+};
+
+struct SessionTokenHash {
+    size_t operator()(const SessionToken& t) const noexcept {
+        uint64_t v;
+        std::memcpy(&v, t.bytes.data(), sizeof(v));
+        return static_cast<size_t>(v);
+    }
+};
+
+#endif // SESSION_TOKEN_H
@@ -0,0 +1,111 @@
+#include "UserInfoCache.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+using namespace std;
+
+static size_t UserCacheCapacity()
+{
+    const char* env = getenv("GS_USER_CACHE_SIZE");
+    size_t n = env ? static_cast<size_t>(strtoul(env, nullptr, 10)) : 0;
+    return n > 0 ? n : 100000;
+}
+
+UserInfoCache& UserInfoCache::getInstance()
+{
+    static UserInfoCache instance(UserCacheCapacity());
+    return instance;
+}
+
+UserInfoCache::UserInfoCache(size_t capacity)
+    : shardCapacity_(max<size_t>(1, (capacity + kShards - 1) / kShards))
+{
+}
+
+UserInfoCache::Shard& UserInfoCache::shardFor(const string& username)
+{
+    return shards_[hash<string>{}(username) % kShards];
+}
+
+bool UserInfoCache::get(const string& username, CachedUserInfo& out, Clock::time_point now)
+{
+    static auto& hits = MetricsRegistry::getInstance().counter(
+        "user_cache_hit_total", "Login lookups answered from the user cache");
+    static auto& misses = MetricsRegistry::getInstance().counter(
+        "user_cache_miss_total", "Login lookups that had to query the user database");
+
+    Shard& s = shardFor(username);
+    {
+        lock_guard<mutex> lk(s.mu);
+        auto it = s.index.find(username);
+        if (it != s.index.end()) {
+            if (it->second->expireAt > now) {
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                out = it->second->info;
+                hits.inc();
+                return true;
+            }
+            s.lru.erase(it->second);
+            s.index.erase(it);
+        }
+    }
+    misses.inc();
+    return false;
+}
+
+uint64_t UserInfoCache::loadTicket(const string& username)
+{
+    Shard& s = shardFor(username);
+    lock_guard<mutex> lk(s.mu);
+    return s.generation;
+}
+
+void UserInfoCache::put(const string& username, const CachedUserInfo& info, uint64_t ticket,
+                        Clock::time_point now)
+{
+    Shard& s = shardFor(username);
+    lock_guard<mutex> lk(s.mu);
+    if (ticket != s.generation) {
+        return; // 查库期间该分片有过 invalidate，结果可能已经过时
+    }
+
+    Clock::time_point expireAt = now + (info.exists ? kPositiveTtl : kNegativeTtl);
+    auto it = s.index.find(username);
+    if (it != s.index.end()) {
+        it->second->info = info;
+        it->second->expireAt = expireAt;
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        return;
+    }
+
+    s.lru.push_front(Entry{username, info, expireAt});
+    s.index.emplace(username, s.lru.begin());
+    if (s.lru.size() > shardCapacity_) {
+        s.index.erase(s.lru.back().username);
+        s.lru.pop_back();
+    }
+}
+
+void UserInfoCache::invalidate(const string& username)
+{
+    Shard& s = shardFor(username);
+    lock_guard<mutex> lk(s.mu);
+    ++s.generation;
+    auto it = s.index.find(username);
+    if (it != s.index.end()) {
+        s.lru.erase(it->second);
+        s.index.erase(it);
+    }
+}
+
+size_t UserInfoCache::size()
+{
+    size_t n = 0;
+    for (auto& s : shards_) {
+        lock_guard<mutex> lk(s.mu);
+        n += s.lru.size();
+    }
+    return n;
+}
@@ -0,0 +1,60 @@
+#ifndef USER_INFO_CACHE_H
+#define USER_INFO_CACHE_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "UserStore.h"
+
+/*
+    登录路径的读穿缓存：username -> CachedUserInfo，按用户名哈希分 16 片，每片一个 LRU + 一把锁
+    - 正向条目 TTL 5 分钟，负向条目 TTL 30 秒（注册后很快就会被查到，不能缓存太久）
+    - 容量默认 10 万，可通过环境变量 GS_USER_CACHE_SIZE 调整，超出时淘汰各分片最久未用的条目
+    - 防止回填旧数据：查库前取 loadTicket，invalidate 会让之前取的 ticket 失效，put 时被丢弃
+    命中/未命中计数导出到 /metrics：user_cache_hit_total、user_cache_miss_total
+*/
+class UserInfoCache {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::chrono::seconds kPositiveTtl{300};
+    static constexpr std::chrono::seconds kNegativeTtl{30};
+
+    static UserInfoCache& getInstance();
+    explicit UserInfoCache(size_t capacity);
+
+    bool get(const std::string& username, CachedUserInfo& out, Clock::time_point now = Clock::now());
+    uint64_t loadTicket(const std::string& username);
+    void put(const std::string& username, const CachedUserInfo& info, uint64_t ticket,
+             Clock::time_point now = Clock::now());
+    void invalidate(const std::string& username);
+
+    size_t size();
+
+private:
+    static constexpr size_t kShards = 16;
+
+    struct Entry {
+        std::string username;
+        CachedUserInfo info;
+        Clock::time_point expireAt;
+    };
+
+    struct Shard {
+        std::mutex mu;
+        std::list<Entry> lru; // 头部最近使用
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        uint64_t generation = 0; // 每次 invalidate 加一
+    };
+
+    Shard& shardFor(const std::string& username);
+
+    size_t shardCapacity_;
+    std::array<Shard, kShards> shards_;
+};
+
+#endif // USER_INFO_CACHE_H
@@ -0,0 +1,55 @@
+#ifndef USER_STORE_H
+#define USER_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+enum class InsertUserStatus {
+    OK,
+    DUPLICATE, // username 唯一键冲突（MySQL 1062）
+    BUSY,      // 连接池耗尽，调用方应回 503
+    DB_ERROR
+};
+
+enum class UserQueryStatus {
+    OK,
+    BUSY,      // 连接池耗尽，调用方应回 503
+    DB_ERROR
+};
+
+// 一个用户名在 sys_user 里的查询结果；exists=false 为负缓存（用户不存在）
+struct CachedUserInfo {
+    bool exists = false;
+    std::string pwdHash;
+};
+
+/*
+    sys_user 的存取接口，QueryUserData 的缓存、布隆过滤器都建在它上面
+    - MySQL 实现（MakeMysqlUserStore）走 GetUserDBPool()
+    - 内存实现（MemoryUserStore.h）用于 GS_STORAGE=memory 的单机压测
+    实现必须线程安全：登录、注册在多个工作线程上并发调用
+*/
+class UserStore {
+public:
+    virtual ~UserStore() = default;
+
+    // 用户不存在时返回 OK、info.exists 为 false
+    virtual UserQueryStatus find(const std::string& username, CachedUserInfo& info) = 0;
+    // username 已存在返回 DUPLICATE；signUpTime 为 unix 秒
+    virtual InsertUserStatus insert(const std::string& username, const std::string& pwdHash,
+                                    const std::string& invCode, int64_t signUpTime) = 0;
+
+    // 布隆过滤器全量加载用：先取总数定容量，再逐个回调用户名；失败返回 false
+    virtual bool countUsers(size_t& count) = 0;
+    virtual bool forEachUsername(const std::function<void(const std::string&)>& fn) = 0;
+};
+
+std::unique_ptr<UserStore> MakeMysqlUserStore();
+
+// 按 GS_STORAGE 选择实现，进程内唯一
+UserStore& GetUserStore();
+
+#endif // USER_STORE_H
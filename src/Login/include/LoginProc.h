@@ -9,4 +9,7 @@
 // 返回true表示连接已交给EventLoop管理，false表示连接应该关闭
 bool ProcLoginRequest(HttpRequest& request, std::shared_ptr<Client> client);
 
+// 设置游戏消息读回调并把连接交给 EventLoop（登录成功 / 断线重连共用）
+void HandOverToEventLoop(std::shared_ptr<Client> client);
+
 #endif // LOGIN_PROC_H
\ No newline at end of file
@@ -1,6 +1,11 @@
 #ifndef RECV_PROC_H
 #define RECV_PROC_H
 
+class HttpRouter;
+
+// 通用HTTP监听：每个连接一个线程，按 router 分发；router 必须在监听期间一直有效
+int ServeHttp(int port, const HttpRouter& router);
+
 // 单独起一个线程调用这个函数，监听Login连接请求
 int ProcLoginReq(int port);
 
@@ -0,0 +1,12 @@
+#ifndef RESUME_PROC_H
+#define RESUME_PROC_H
+
+#include <memory>
+#include "Client.h"
+#include "ParseHttp.h"
+
+// 断线重连：校验 resumeToken 签名后直接挂回已有会话，不查库、不跑 Argon2
+// 返回true表示连接已交给EventLoop管理，false表示连接应该关闭
+bool ProcResumeRequest(HttpRequest& request, std::shared_ptr<Client> client);
+
+#endif // RESUME_PROC_H
@@ -0,0 +1,33 @@
+#ifndef SESSION_SNAPSHOT_H
+#define SESSION_SNAPSHOT_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+/*
+    会话快照：把 UserSessionManager 里的会话写进一个紧凑的二进制文件，重启后直接映射回来
+    - 部署重启后客户端凭 resumeToken 走 /api/resume 挂回会话，不会一起涌向登录（查库 + Argon2）
+    - 文件里同时保存 resumeToken 的签名密钥，否则重启后旧令牌全部验签失败
+    - 先写 path.tmp 再 rename，崩溃时不会留下半个文件；权限 0600（含密钥）
+    文件格式（小端）：
+        header: magic "GSSN"(4) | version(2) | reserved(2) | count(4) | reserved(4)
+                | savedAt(8, unix 毫秒) | resumeKey(32)
+        record: token(16) | createdAt(8) | lastAccessAt(8) | expireAt(8) | usernameLen(1) | username
+*/
+
+// 快照文件路径：环境变量 GS_SESSION_SNAPSHOT，默认 ./session.snap
+std::string SessionSnapshotPath();
+
+// 返回写入的会话数，失败返回 -1
+long SaveSessionSnapshot(const std::string& path);
+// 返回恢复的会话数（已过期的跳过）；文件不存在或损坏返回 0
+size_t LoadSessionSnapshot(const std::string& path);
+
+// 屏蔽 SIGINT/SIGTERM，必须在创建任何线程之前调用，信号统一交给快照线程处理
+void BlockShutdownSignals();
+// 快照线程：每 interval 写一次快照；收到 SIGINT/SIGTERM 时依次执行退出钩子（ShutdownHooks.h）、
+// 写最后一次快照后退出进程
+void StartSessionSnapshotter(const std::string& path, std::chrono::seconds interval);
+
+#endif // SESSION_SNAPSHOT_H
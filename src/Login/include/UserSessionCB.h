@@ -2,17 +2,23 @@
 #define USERSESSIONCB_H
 
 #include <string>
+#include <string_view>
 #include <chrono>
-#include <unordered_map>
-#include <variant>
 #include <cstdint>
 #include <mutex>
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <functional>
+#include "SessionToken.h"
+#include "SessionAttrs.h"
+#include "ShardedMap.h"
+#include "TimingWheel.h"
+
+class EventLoop;
 struct UserSessionData {
     std::string username;
-    std::string token;
+    SessionToken token;
     std::string clientIp;
 
     // ---- lifecycle ----
@@ -22,49 +28,118 @@ struct UserSessionData {
     TimePoint lastAccessAt{};
     TimePoint expireAt{};
 
-    using Attr = std::variant<int64_t, double, bool, std::string>;
-    std::unordered_map<std::string, Attr> attrs;
+    SessionAttrs attrs; // 按 AttrKey 存取，见 SessionAttrs.h
 };
 
 class UserSessionCB {
 public:
     using Clock = UserSessionData::Clock;
     using TimePoint = UserSessionData::TimePoint;
+    static constexpr std::chrono::hours kDefaultTtl{1};
 
-    explicit UserSessionCB(const std::string& token, const std::string& username, int clientFd);
+    explicit UserSessionCB(const SessionToken& token, const std::string& username, int clientFd, uint64_t connId);
     ~UserSessionCB() = default;
 
     bool isExpired(TimePoint now = Clock::now()) const;
-    void touch(TimePoint now = Clock::now());
-    int getClientFd() const { return clientFd_; }
+    TimePoint getExpireAt() const { std::scoped_lock lk(mu_); return data_.expireAt; }
+    TimePoint getCreatedAt() const { std::scoped_lock lk(mu_); return data_.createdAt; }
+    TimePoint getLastAccessAt() const { std::scoped_lock lk(mu_); return data_.lastAccessAt; }
+    // 从快照恢复时还原时间戳
+    void restoreTimes(TimePoint createdAt, TimePoint lastAccessAt, TimePoint expireAt);
+    void touch(TimePoint now = Clock::now()); // 滑动过期：每次访问都把过期时间顺延 kDefaultTtl
+    int getClientFd() const { std::scoped_lock lk(mu_); return clientFd_; }
+    uint64_t getConnId() const { std::scoped_lock lk(mu_); return connId_; }
+    // 断线重连：会话不变，换绑到新连接（索引由 UserSessionManager::rebindSession 维护）
+    void rebindClient(int clientFd, uint64_t connId);
+    // 类型化属性访问，键用 SessionAttr 枚举或 SessionAttrRegistry::intern 的结果
+    template <typename T>
+    bool getAttr(AttrKey key, T& out) const { std::scoped_lock lk(mu_); return data_.attrs.get(key, out); }
+    template <typename T>
+    void setAttr(AttrKey key, T&& value) { std::scoped_lock lk(mu_); data_.attrs.set(key, std::forward<T>(value)); }
+    bool eraseAttr(AttrKey key) { std::scoped_lock lk(mu_); return data_.attrs.erase(key); }
+    const std::string& getUsername() const { return data_.username; } // 创建后不变
+    const SessionToken& getToken() const { return data_.token; }      // 创建后不变
 private:
     mutable std::mutex mu_;
     UserSessionData data_;
     int clientFd_;
+    uint64_t connId_;
 };
 
 class UserSessionManager {
 public:
+    using TimePoint = UserSessionCB::TimePoint;
+
     static UserSessionManager& getInstance();
 
-    std::shared_ptr<UserSessionCB> createSession(const std::string& token,
+    // 过期检查挂到 loop 的定时器上，每秒转一格时间轮；启动监听前调用一次
+    void startExpiry(EventLoop* loop);
+
+    // 同一用户重复登录时，旧会话被移除，旧连接收到通知后关闭
+    std::shared_ptr<UserSessionCB> createSession(const SessionToken& token,
+                                                 const std::string& username,
+                                                 int clientFd,
+                                                 uint64_t connId);
+    void rebindSession(const std::shared_ptr<UserSessionCB>& ses, int clientFd, uint64_t connId);
+    // /api/resume 时会话已不在（断线清理、重启）：按原 token 重建。token 已吊销（被顶号、过期）
+    // 或这个用户已经有别的会话时返回 nullptr，不会像 createSession 那样把现有会话踢掉
+    std::shared_ptr<UserSessionCB> resumeSession(const SessionToken& token,
                                                  const std::string& username,
-                                                 int clientFd);
+                                                 int clientFd,
+                                                 uint64_t connId);
+    // 被顶号或过期移除的会话 token 不能再凭 resumeToken 恢复，记录保留 kDefaultTtl（续期令牌的最长有效期）
+    bool isRevoked(const SessionToken& token) const;
 
-    std::shared_ptr<UserSessionCB> getSession(const std::string& token);
+    std::shared_ptr<UserSessionCB> getSession(const SessionToken& token);
+    std::shared_ptr<UserSessionCB> getSession(std::string_view hexToken); // 协议层的 hex 形式
+    std::shared_ptr<UserSessionCB> getSessionByUser(const std::string& username);
+    std::shared_ptr<UserSessionCB> getSessionByConn(uint64_t connId);
+
+    // 给在线玩家发消息，玩家不在线返回 false
+    bool sendToUser(const std::string& username, std::string data);
+
+    // 从快照恢复的会话没有连接（clientFd=-1），等客户端 /api/resume 时再绑定
+    std::shared_ptr<UserSessionCB> restoreSession(const SessionToken& token,
+                                                  const std::string& username,
+                                                  TimePoint createdAt,
+                                                  TimePoint lastAccessAt,
+                                                  TimePoint expireAt);
+    // 逐分片遍历所有会话（持有分片读锁期间调用 fn，fn 里不要再访问会话表）
+    void forEachSession(const std::function<void(const std::shared_ptr<UserSessionCB>&)>& fn) const;
+
+    // 连接从 EventLoop 移除时调用，立即清理该连接上的会话（重连走 /api/resume 重建）
+    void onDisconnect(uint64_t connId);
 
 private:
-    UserSessionManager();
+    UserSessionManager() = default;
 
     ~UserSessionManager() = default;
-    void auditSessions();
-    std::string buildSessionExpiredResponse(const std::string& token); // 构造会话过期响应
+    void scheduleExpiry(const std::shared_ptr<UserSessionCB>& ses); // 把会话挂到时间轮上
+    void onExpiryTick();                                           // loop 线程：处理到期的会话
+    void removeSession(const std::shared_ptr<UserSessionCB>& ses); // 从主表与所有索引中移除
+    void removeIndexes(const std::shared_ptr<UserSessionCB>& ses);
+    void revokeToken(const SessionToken& token);
+    void pruneRevoked(TimePoint now); // 每个刻度清一个分片里过了期限的吊销记录
+    // 通知并关闭会话所在连接；在 loop 线程里用 connId 校验，防止 fd 复用后关错连接
+    void closeSessionConn(const std::shared_ptr<UserSessionCB>& ses, std::string notice);
+    std::string buildSessionExpiredResponse(const SessionToken& token); // 构造会话过期响应
+    std::string buildSessionReplacedResponse(const SessionToken& token); // 构造重复登录踢下线响应
     UserSessionManager(const UserSessionManager&) = delete;
     UserSessionManager& operator=(const UserSessionManager&) = delete;
 
-    std::mutex mu_;
-    std::unordered_map<std::string, std::shared_ptr<UserSessionCB>> sessions_;
+    using SessionTable = ShardedMap<SessionToken, std::shared_ptr<UserSessionCB>, SessionTokenHash, 64>;
+    SessionTable sessions_;
+    // 二级索引，值是主表的 token；删除时用 eraseIf 比对 token，避免误删已被新会话覆盖的索引
+    ShardedMap<std::string, SessionToken> byUser_;
+    ShardedMap<uint64_t, SessionToken> byConn_;
+    ShardedMap<SessionToken, TimePoint, SessionTokenHash> revoked_; // token -> 吊销记录保留到何时
+    size_t revokedPruneShard_ = 0; // 只在 expiryLoop_ 线程访问
     std::atomic<uint64_t> sessionCounter_{0};
+
+    static constexpr std::chrono::seconds kExpiryTick{1};
+    static constexpr size_t kMaxExpirePerTick = 256; // 每个刻度最多处理的到期会话，剩下的顺延到下个刻度
+    std::atomic<EventLoop*> expiryLoop_{nullptr};
+    TimingWheel<std::weak_ptr<UserSessionCB>> expiryWheel_{512}; // 只在 expiryLoop_ 线程访问
 };
 
 #endif // USERSESSIONCB_H
\ No newline at end of file
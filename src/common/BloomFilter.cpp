@@ -0,0 +1,59 @@
+#include "BloomFilter.h"
+#include <algorithm>
+#include <cmath>
+
+BloomFilter::BloomFilter(size_t expectedItems, double falsePositiveRate)
+{
+    expectedItems = std::max<size_t>(expectedItems, 1);
+    falsePositiveRate = std::min(std::max(falsePositiveRate, 1e-6), 0.5);
+
+    // m = -n * ln(p) / (ln2)^2，k = m / n * ln2
+    const double ln2 = std::log(2.0);
+    double bits = -static_cast<double>(expectedItems) * std::log(falsePositiveRate) / (ln2 * ln2);
+    wordCount_ = std::max<size_t>(1, static_cast<size_t>(std::ceil(bits / 64.0)));
+    hashCount_ = std::max<size_t>(1, static_cast<size_t>(std::round(bitCount() / static_cast<double>(expectedItems) * ln2)));
+    words_.reset(new std::atomic<uint64_t>[wordCount_]());
+}
+
+// FNV-1a 再做一次 64 位混合，短用户名也能把位打散
+uint64_t BloomFilter::hash64(std::string_view key)
+{
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+void BloomFilter::add(std::string_view key)
+{
+    uint64_t h = hash64(key);
+    uint64_t h1 = h;
+    uint64_t h2 = (h >> 32) | 1;
+    const uint64_t bits = bitCount();
+    for (size_t i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) % bits;
+        words_[bit / 64].fetch_or(1ull << (bit % 64), std::memory_order_relaxed);
+    }
+}
+
+bool BloomFilter::mightContain(std::string_view key) const
+{
+    uint64_t h = hash64(key);
+    uint64_t h1 = h;
+    uint64_t h2 = (h >> 32) | 1;
+    const uint64_t bits = bitCount();
+    for (size_t i = 0; i < hashCount_; ++i) {
+        uint64_t bit = (h1 + i * h2) % bits;
+        if (!(words_[bit / 64].load(std::memory_order_relaxed) & (1ull << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+/*
+    布隆过滤器：mightContain 返回 false 表示一定不存在，返回 true 只表示可能存在
+    - 位数组按 expectedItems / falsePositiveRate 计算，k 个哈希用双重哈希从一个 64 位哈希派生
+    - 位数组是原子字，add 用 fetch_or，add/mightContain 可以并发调用，不加锁
+    - 不支持删除；实际元素数超过 expectedItems 后误判率升高，但不会出现漏判
+*/
+class BloomFilter {
+public:
+    BloomFilter(size_t expectedItems, double falsePositiveRate);
+
+    void add(std::string_view key);
+    bool mightContain(std::string_view key) const;
+
+    size_t bitCount() const { return wordCount_ * 64; }
+    size_t hashCount() const { return hashCount_; }
+
+private:
+    static uint64_t hash64(std::string_view key);
+
+    size_t wordCount_;
+    size_t hashCount_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+#endif // BLOOM_FILTER_H
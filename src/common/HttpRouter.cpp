@@ -0,0 +1,179 @@
+#include "HttpRouter.h"
+#include "LogM.h"
+
+using namespace std;
+
+HttpMethod ParseHttpMethod(string_view method)
+{
+    if (method == "GET") return HttpMethod::GET;
+    if (method == "POST") return HttpMethod::POST;
+    if (method == "PUT") return HttpMethod::PUT;
+    if (method == "DELETE") return HttpMethod::DELETE;
+    if (method == "HEAD") return HttpMethod::HEAD;
+    return HttpMethod::UNKNOWN;
+}
+
+string_view RouteParams::get(string_view name) const
+{
+    for (size_t i = 0; i < count_; ++i) {
+        if (items_[i].first == name) {
+            return items_[i].second;
+        }
+    }
+    return {};
+}
+
+bool RouteParams::push(string_view name, string_view value)
+{
+    if (count_ >= kMaxParams) {
+        return false;
+    }
+    items_[count_++] = {name, value};
+    return true;
+}
+
+HttpRouter::HttpRouter()
+{
+    nodes_.emplace_back(); // 根节点，对应 "/"
+}
+
+// 取出下一个非空路径段，并把 rest 推进到该段之后
+string_view HttpRouter::nextSegment(string_view& rest)
+{
+    while (!rest.empty() && rest.front() == '/') {
+        rest.remove_prefix(1);
+    }
+    size_t end = rest.find('/');
+    string_view seg = rest.substr(0, end);
+    rest.remove_prefix(end == string_view::npos ? rest.size() : end);
+    return seg;
+}
+
+bool HttpRouter::addRoute(HttpMethod method, string_view pattern, Handler handler)
+{
+    if (method == HttpMethod::UNKNOWN || !handler) {
+        LOG_ERROR("HttpRouter::addRoute invalid route: %.*s", (int)pattern.size(), pattern.data());
+        return false;
+    }
+
+    int cur = 0;
+    size_t paramCount = 0;
+    string_view rest = pattern;
+    for (string_view seg = nextSegment(rest); !seg.empty(); seg = nextSegment(rest)) {
+        if (seg.front() == ':') {
+            if (++paramCount > RouteParams::kMaxParams) {
+                LOG_ERROR("HttpRouter::addRoute too many params: %.*s", (int)pattern.size(), pattern.data());
+                return false;
+            }
+            string_view name = seg.substr(1);
+            int child = nodes_[cur].paramChild;
+            if (child < 0) {
+                child = static_cast<int>(nodes_.size());
+                nodes_.emplace_back();
+                nodes_[child].segment = string(name);
+                nodes_[cur].paramChild = child;
+            } else if (nodes_[child].segment != name) {
+                // 同一位置的参数名必须一致，否则 RouteParams::get 的语义会混乱
+                LOG_ERROR("HttpRouter::addRoute conflicting param name: %.*s", (int)pattern.size(), pattern.data());
+                return false;
+            }
+            cur = child;
+            continue;
+        }
+
+        int next = -1;
+        for (int child : nodes_[cur].staticChildren) {
+            if (nodes_[child].segment == seg) {
+                next = child;
+                break;
+            }
+        }
+        if (next < 0) {
+            next = static_cast<int>(nodes_.size());
+            nodes_.emplace_back();
+            nodes_[next].segment = string(seg);
+            nodes_[cur].staticChildren.push_back(next);
+        }
+        cur = next;
+    }
+
+    int& slot = nodes_[cur].handlers[static_cast<size_t>(method)];
+    if (slot >= 0) {
+        LOG_ERROR("HttpRouter::addRoute duplicate route: %.*s", (int)pattern.size(), pattern.data());
+        return false;
+    }
+    slot = static_cast<int>(handlers_.size());
+    handlers_.push_back(std::move(handler));
+    return true;
+}
+
+// 返回注册了 method 的匹配节点下标，-1 表示没有；静态段优先，走不通时回溯到参数段
+// 路径匹配上但方法没注册的节点，把它有的方法记进 allowed（按 HttpMethod 编号的位图），用于 405
+int HttpRouter::matchNode(int nodeIdx, string_view rest, HttpMethod method, RouteParams& params,
+                          uint32_t& allowed) const
+{
+    string_view seg = nextSegment(rest);
+    const Node& node = nodes_[nodeIdx];
+    if (seg.empty()) {
+        if (method != HttpMethod::UNKNOWN && node.handlers[static_cast<size_t>(method)] >= 0) {
+            return nodeIdx;
+        }
+        for (size_t m = 0; m < kMethodCount; ++m) {
+            if (node.handlers[m] >= 0) allowed |= 1u << m;
+        }
+        return -1;
+    }
+
+    for (int child : node.staticChildren) {
+        if (nodes_[child].segment == seg) {
+            int found = matchNode(child, rest, method, params, allowed);
+            if (found >= 0) return found;
+            break;
+        }
+    }
+
+    if (node.paramChild >= 0) {
+        size_t saved = params.size();
+        if (params.push(nodes_[node.paramChild].segment, seg)) {
+            int found = matchNode(node.paramChild, rest, method, params, allowed);
+            if (found >= 0) return found;
+        }
+        params.truncate(saved);
+    }
+    return -1;
+}
+
+HttpRouter::MatchResult HttpRouter::match(HttpMethod method, string_view path,
+                                          const Handler*& handler, RouteParams& params, string* allow) const
+{
+    static const char* const kMethodNames[kMethodCount] = {"GET", "POST", "PUT", "DELETE", "HEAD"};
+
+    handler = nullptr;
+    params.truncate(0);
+
+    size_t query = path.find('?');
+    if (query != string_view::npos) {
+        path = path.substr(0, query);
+    }
+
+    uint32_t allowed = 0;
+    int nodeIdx = matchNode(0, path, method, params, allowed);
+    if (nodeIdx >= 0) {
+        handler = &handlers_[nodes_[nodeIdx].handlers[static_cast<size_t>(method)]];
+        return MatchResult::Found;
+    }
+
+    params.truncate(0);
+    if (allowed == 0) {
+        return MatchResult::NotFound;
+    }
+    if (allow) {
+        allow->clear();
+        for (size_t m = 0; m < kMethodCount; ++m) {
+            if (!(allowed & (1u << m))) continue;
+            if (!allow->empty()) allow->append(", ");
+            allow->append(kMethodNames[m]);
+        }
+    }
+    return MatchResult::MethodNotAllowed;
+}
@@ -0,0 +1,97 @@
+#ifndef HTTP_ROUTER_H
+#define HTTP_ROUTER_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ParseHttp.h"
+
+class Client;
+
+enum class HttpMethod : uint8_t {
+    GET = 0,
+    POST,
+    PUT,
+    DELETE,
+    HEAD,
+    UNKNOWN
+};
+
+HttpMethod ParseHttpMethod(std::string_view method);
+
+/*
+    路径参数，定长数组保存 name/value 的 string_view：
+    - name 指向路由表里注册的模式串，value 指向请求里的 path
+    - 查找过程不做任何堆分配，因此 HttpRequest 必须比 RouteParams 活得久
+*/
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 4;
+
+    std::string_view get(std::string_view name) const;
+    size_t size() const { return count_; }
+
+private:
+    friend class HttpRouter;
+    bool push(std::string_view name, std::string_view value);
+    void truncate(size_t count) { count_ = count; }
+
+    std::array<std::pair<std::string_view, std::string_view>, kMaxParams> items_{};
+    size_t count_ = 0;
+};
+
+/*
+    按 method + path 注册的路由表（按路径段组织的前缀树）
+        router.addRoute(HttpMethod::POST, "/api/login", handler);
+        router.addRoute(HttpMethod::GET,  "/api/server/:id/notice", handler);
+    - ":" 开头的段为路径参数，静态段优先于参数段匹配；静态分支走不通（包括走到底但没有注册这个方法）
+      时回溯到参数段，/a/b 只注册了 POST 时 GET /a/b 仍能落到 GET /a/:x
+    - 路由表在监听线程启动前构建完成，之后只读，可被多个 handle_client 线程并发 match
+*/
+class HttpRouter {
+public:
+    // 返回true表示连接已交给EventLoop管理，false表示连接应该关闭
+    using Handler = std::function<bool(HttpRequest&, std::shared_ptr<Client>, const RouteParams&)>;
+
+    enum class MatchResult {
+        Found,
+        NotFound,
+        MethodNotAllowed
+    };
+
+    HttpRouter();
+
+    bool addRoute(HttpMethod method, std::string_view pattern, Handler handler);
+
+    // path 可以带 query string，匹配时忽略 '?' 之后的部分
+    // 返回 MethodNotAllowed 时，allow 非空则填上这个路径上注册过的方法（Allow 头的值，如 "GET, POST"）
+    MatchResult match(HttpMethod method, std::string_view path,
+                      const Handler*& handler, RouteParams& params, std::string* allow = nullptr) const;
+
+private:
+    static constexpr size_t kMethodCount = static_cast<size_t>(HttpMethod::UNKNOWN);
+
+    struct Node {
+        std::string segment;            // 静态段文本（参数节点为参数名）
+        std::vector<int> staticChildren;
+        int paramChild = -1;
+        std::array<int, kMethodCount> handlers; // handlers_ 下标，-1 表示该方法未注册
+
+        Node() { handlers.fill(-1); }
+    };
+
+    int matchNode(int nodeIdx, std::string_view rest, HttpMethod method, RouteParams& params,
+                  uint32_t& allowed) const;
+    static std::string_view nextSegment(std::string_view& rest);
+
+    std::vector<Node> nodes_;
+    std::vector<Handler> handlers_;
+};
+
+#endif // HTTP_ROUTER_H
@@ -0,0 +1,196 @@
+#include "JsonWriter.h"
+#include "LogM.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+void AppendJsonEscaped(string& out, string_view s)
+{
+    static const char kHex[] = "0123456789abcdef";
+
+    // 大部分字段（token、用户名、固定文案）不需要转义，按段整体拷贝
+    size_t runStart = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        const char* esc = nullptr;
+        switch (c) {
+        case '"':  esc = "\\\""; break;
+        case '\\': esc = "\\\\"; break;
+        case '\b': esc = "\\b"; break;
+        case '\f': esc = "\\f"; break;
+        case '\n': esc = "\\n"; break;
+        case '\r': esc = "\\r"; break;
+        case '\t': esc = "\\t"; break;
+        default:
+            if (c >= 0x20) continue;
+            break;
+        }
+        out.append(s.data() + runStart, i - runStart);
+        if (esc) {
+            out.append(esc);
+        } else {
+            char buf[6] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+            out.append(buf, sizeof(buf));
+        }
+        runStart = i + 1;
+    }
+    out.append(s.data() + runStart, s.size() - runStart);
+}
+
+//==================================JsonWriter============================================//
+
+void JsonWriter::beforeValue()
+{
+    if (afterKey_) {
+        afterKey_ = false;
+        return;
+    }
+    if (depth_ > 0) {
+        if (!first_[depth_]) {
+            out_.push_back(',');
+        }
+        first_[depth_] = false;
+    }
+}
+
+JsonWriter& JsonWriter::open(char c)
+{
+    if (depth_ >= kMaxDepth) {
+        LOG_ERROR("JsonWriter nesting too deep");
+        ok_ = false;
+        return *this;
+    }
+    beforeValue();
+    out_.push_back(c);
+    first_[++depth_] = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::close(char c)
+{
+    if (depth_ == 0 || afterKey_) {
+        LOG_ERROR("JsonWriter unbalanced '%c'", c);
+        ok_ = false;
+        return *this;
+    }
+    --depth_;
+    out_.push_back(c);
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginObject() { return open('{'); }
+JsonWriter& JsonWriter::endObject() { return close('}'); }
+JsonWriter& JsonWriter::beginArray() { return open('['); }
+JsonWriter& JsonWriter::endArray() { return close(']'); }
+
+JsonWriter& JsonWriter::key(string_view k)
+{
+    beforeValue();
+    out_.push_back('"');
+    AppendJsonEscaped(out_, k);
+    out_.append("\":", 2);
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(string_view v)
+{
+    beforeValue();
+    out_.push_back('"');
+    AppendJsonEscaped(out_, v);
+    out_.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int64_t v)
+{
+    beforeValue();
+    char buf[24];
+    auto end = to_chars(buf, buf + sizeof(buf), v).ptr;
+    out_.append(buf, static_cast<size_t>(end - buf));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t v)
+{
+    beforeValue();
+    char buf[24];
+    auto end = to_chars(buf, buf + sizeof(buf), v).ptr;
+    out_.append(buf, static_cast<size_t>(end - buf));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double v)
+{
+    beforeValue();
+    if (!std::isfinite(v)) {
+        out_.append("null"); // JSON 没有 NaN/Inf，与 nlohmann::json::dump 行为一致
+        return *this;
+    }
+    char buf[32];
+    int n = snprintf(buf, sizeof(buf), "%.17g", v);
+    out_.append(buf, static_cast<size_t>(n));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool v)
+{
+    beforeValue();
+    out_.append(v ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+    beforeValue();
+    out_.append("null");
+    return *this;
+}
+
+//==================================JsonTemplate============================================//
+
+JsonTemplate::JsonTemplate(string_view pattern)
+{
+    static constexpr string_view kSlot = "${}";
+    size_t start = 0;
+    for (size_t pos = pattern.find(kSlot); pos != string_view::npos; pos = pattern.find(kSlot, start)) {
+        literals_.emplace_back(pattern.substr(start, pos - start));
+        start = pos + kSlot.size();
+    }
+    literals_.emplace_back(pattern.substr(start));
+
+    for (const auto& lit : literals_) {
+        literalSize_ += lit.size();
+    }
+}
+
+void JsonTemplate::render(string& out, initializer_list<string_view> args) const
+{
+    if (args.size() != slotCount()) {
+        LOG_ERROR("JsonTemplate expects %zu args, got %zu", slotCount(), args.size());
+    }
+
+    size_t argSize = 0;
+    for (auto a : args) {
+        argSize += a.size();
+    }
+    out.reserve(out.size() + literalSize_ + argSize);
+
+    auto arg = args.begin();
+    out.append(literals_[0]);
+    for (size_t i = 1; i < literals_.size(); ++i) {
+        if (arg != args.end()) {
+            AppendJsonEscaped(out, *arg++);
+        }
+        out.append(literals_[i]);
+    }
+}
+
+string JsonTemplate::render(initializer_list<string_view> args) const
+{
+    string out;
+    render(out, args);
+    return out;
+}
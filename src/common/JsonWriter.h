@@ -0,0 +1,80 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 把 s 按 JSON 字符串规则转义后追加到 out（不含两侧引号）
+void AppendJsonEscaped(std::string& out, std::string_view s);
+
+/*
+    流式 JSON 写入器（SAX 风格），直接往调用方的缓冲区追加，不构造 nlohmann::json DOM：
+        std::string body;
+        JsonWriter w(body);
+        w.beginObject().field("status", "success").field("token", token).endObject();
+    逗号由写入器自动维护；嵌套深度上限 kMaxDepth，超出后的写入会被忽略并记录错误
+*/
+class JsonWriter {
+public:
+    static constexpr int kMaxDepth = 32;
+
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view k);
+
+    JsonWriter& value(std::string_view v);
+    JsonWriter& value(const char* v) { return value(std::string_view(v)); }
+    JsonWriter& value(const std::string& v) { return value(std::string_view(v)); }
+    JsonWriter& value(int64_t v);
+    JsonWriter& value(int v) { return value(static_cast<int64_t>(v)); }
+    JsonWriter& value(uint64_t v);
+    JsonWriter& value(double v);
+    JsonWriter& value(bool v);
+    JsonWriter& null();
+
+    template <typename T>
+    JsonWriter& field(std::string_view k, const T& v) { return key(k).value(v); }
+
+    bool ok() const { return ok_ && depth_ == 0; }
+
+private:
+    void beforeValue();
+    JsonWriter& open(char c);
+    JsonWriter& close(char c);
+
+    std::string& out_;
+    bool first_[kMaxDepth + 1] = {true};
+    int depth_ = 0;
+    bool afterKey_ = false;
+    bool ok_ = true;
+};
+
+/*
+    固定结构响应的模板，构造时把字面量切好，渲染时只做拷贝 + 转义替换：
+        static const JsonTemplate tpl(R"({"status":"success","token":"${}"})");
+        tpl.render(body, {token});
+    "${}" 为按顺序的占位符，实参会做 JSON 字符串转义；数字等非字符串字段把占位符放在引号外即可
+*/
+class JsonTemplate {
+public:
+    explicit JsonTemplate(std::string_view pattern);
+
+    size_t slotCount() const { return literals_.size() - 1; }
+
+    void render(std::string& out, std::initializer_list<std::string_view> args) const;
+    std::string render(std::initializer_list<std::string_view> args) const;
+
+private:
+    std::vector<std::string> literals_; // 占位符之间的字面量，比占位符多一个
+    size_t literalSize_ = 0;
+};
+
+#endif // JSON_WRITER_H
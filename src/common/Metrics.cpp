@@ -0,0 +1,89 @@
+#include "Metrics.h"
+
+using namespace std;
+
+void LatencyHistogram::observe(uint64_t value)
+{
+    size_t i = 0;
+    while (i < kBounds.size() && value > kBounds[i]) {
+        ++i;
+    }
+    buckets_[i].fetch_add(1, memory_order_relaxed);
+    count_.fetch_add(1, memory_order_relaxed);
+    sum_.fetch_add(value, memory_order_relaxed);
+}
+
+MetricsRegistry& MetricsRegistry::getInstance()
+{
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricCounter& MetricsRegistry::counter(const string& name, const string& help)
+{
+    lock_guard<mutex> lk(mu_);
+    auto& e = counters_[name];
+    if (!e.metric) {
+        e.help = help;
+        e.metric = make_unique<MetricCounter>();
+    }
+    return *e.metric;
+}
+
+MetricGauge& MetricsRegistry::gauge(const string& name, const string& help)
+{
+    lock_guard<mutex> lk(mu_);
+    auto& e = gauges_[name];
+    if (!e.metric) {
+        e.help = help;
+        e.metric = make_unique<MetricGauge>();
+    }
+    return *e.metric;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const string& name, const string& help)
+{
+    lock_guard<mutex> lk(mu_);
+    auto& e = histograms_[name];
+    if (!e.metric) {
+        e.help = help;
+        e.metric = make_unique<LatencyHistogram>();
+    }
+    return *e.metric;
+}
+
+static void appendHeader(string& out, const string& name, const string& help, const char* type)
+{
+    if (!help.empty()) {
+        out += "# HELP " + name + " " + help + "\n";
+    }
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+string MetricsRegistry::render() const
+{
+    lock_guard<mutex> lk(mu_);
+    string out;
+
+    for (const auto& [name, e] : counters_) {
+        appendHeader(out, name, e.help, "counter");
+        out += name + " " + to_string(e.metric->value()) + "\n";
+    }
+    for (const auto& [name, e] : gauges_) {
+        appendHeader(out, name, e.help, "gauge");
+        out += name + " " + to_string(e.metric->value()) + "\n";
+    }
+    for (const auto& [name, e] : histograms_) {
+        appendHeader(out, name, e.help, "histogram");
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < LatencyHistogram::kBounds.size(); ++i) {
+            cumulative += e.metric->bucket(i);
+            out += name + "_bucket{le=\"" + to_string(LatencyHistogram::kBounds[i]) + "\"} " + to_string(cumulative) + "\n";
+        }
+        cumulative += e.metric->bucket(LatencyHistogram::kBounds.size());
+        out += name + "_bucket{le=\"+Inf\"} " + to_string(cumulative) + "\n";
+        out += name + "_sum " + to_string(e.metric->sum()) + "\n";
+        out += name + "_count " + to_string(e.metric->count()) + "\n";
+    }
+    return out;
+}
@@ -0,0 +1,87 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+    进程内指标：计数器 / 仪表 / 延迟直方图，全部是无锁原子操作，可以放在热路径上
+    - 注册表只在第一次取指标时加锁，调用方用 static 引用缓存：
+        static auto& hist = MetricsRegistry::getInstance().histogram("pwhash_duration_us", "...");
+        hist.observe(us);
+    - render() 输出 Prometheus 文本格式，由管理端口 GET /metrics 返回
+*/
+class MetricCounter {
+public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class MetricGauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t d) { value_.fetch_add(d, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// 固定桶的直方图，单位由名字约定（_us 结尾即微秒），桶上界覆盖 10us ~ 10s
+class LatencyHistogram {
+public:
+    static constexpr std::array<uint64_t, 16> kBounds = {
+        10, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000,
+        50000, 100000, 250000, 500000, 1000000, 10000000
+    };
+
+    void observe(uint64_t value);
+    void observe(std::chrono::steady_clock::duration d) {
+        observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count()));
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t bucket(size_t i) const { return buckets_[i].load(std::memory_order_relaxed); } // i == kBounds.size() 为 +Inf
+
+private:
+    std::array<std::atomic<uint64_t>, kBounds.size() + 1> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& getInstance();
+
+    MetricCounter& counter(const std::string& name, const std::string& help = "");
+    MetricGauge& gauge(const std::string& name, const std::string& help = "");
+    LatencyHistogram& histogram(const std::string& name, const std::string& help = "");
+
+    std::string render() const;
+
+private:
+    MetricsRegistry() = default;
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    template <typename T>
+    struct Entry {
+        std::string help;
+        std::unique_ptr<T> metric;
+    };
+
+    mutable std::mutex mu_;
+    std::map<std::string, Entry<MetricCounter>> counters_;
+    std::map<std::string, Entry<MetricGauge>> gauges_;
+    std::map<std::string, Entry<LatencyHistogram>> histograms_;
+};
+
+#endif // METRICS_H
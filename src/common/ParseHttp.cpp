@@ -1,6 +1,7 @@
 #include "ParseHttp.h"
 #include "json.hpp"
 #include "LogM.h"
+#include <cctype>
 
 using namespace std;
 /*
@@ -36,7 +37,14 @@ HttpRequest::HttpRequest(const string strIn)
     // 解析头部
     istringstream headerStream(headerPart);
     string line;
-    while (getline(headerStream, line) && line != "\r") {
+    while (getline(headerStream, line)) {
+        // getline 按 '\n' 切行，行尾的 '\r' 要去掉
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            break;
+        }
         size_t colon_pos = line.find(':');
         if (colon_pos != string::npos) {
             string key = line.substr(0, colon_pos);
@@ -61,6 +69,26 @@ string HttpRequest::getParam(const string& key)
         ParseBody();
     }
     
+    if (body_type == BodyType::JSON && !json_dom_built) {
+        const JsonField* field = FindJsonField(key);
+        if (!field) {
+            return "";
+        }
+        switch (field->kind) {
+        case JsonValueKind::STRING:
+        case JsonValueKind::SCALAR:
+            return string(field->raw);
+        case JsonValueKind::ESCAPED_STRING: {
+            string value;
+            UnescapeJsonString(field->raw, value);
+            return value;
+        }
+        case JsonValueKind::COMPLEX:
+            getJson(); // 嵌套值交给 DOM，保持与 dump() 一致的输出
+            break;
+        }
+    }
+
     if (body_type == BodyType::JSON) {
         if (json_body.contains(key)) {
             auto& value = json_body[key];
@@ -76,11 +104,44 @@ string HttpRequest::getParam(const string& key)
     return "";
 }
 
+string_view HttpRequest::getParamView(string_view key)
+{
+    if (!body_parsed) {
+        ParseBody();
+    }
+
+    if (body_type == BodyType::JSON && !json_dom_built) {
+        const JsonField* field = FindJsonField(key);
+        if (!field) {
+            return {};
+        }
+        if (field->kind == JsonValueKind::STRING || field->kind == JsonValueKind::SCALAR) {
+            return field->raw;
+        }
+        if (field->kind == JsonValueKind::ESCAPED_STRING) {
+            unescaped_values.emplace_back();
+            UnescapeJsonString(field->raw, unescaped_values.back());
+            return unescaped_values.back();
+        }
+    }
+
+    // 表单或 DOM 路径：结果缓存到 unescaped_values，保证返回的 view 有效
+    string value = getParam(string(key));
+    if (value.empty()) {
+        return {};
+    }
+    unescaped_values.push_back(std::move(value));
+    return unescaped_values.back();
+}
+
 const nlohmann::json& HttpRequest::getJson()
 {
     if (!body_parsed) {
         ParseBody();
     }
+    if (body_type == BodyType::JSON && !json_dom_built) {
+        ParseJsonBody(); // 按需解析只扫了顶层字段，这里才真正构造 DOM
+    }
     return json_body;
 }
 
@@ -131,6 +192,7 @@ void HttpRequest::ParseJsonBody()
 {
     try {
         json_body = nlohmann::json::parse(body);
+        json_dom_built = true;
         body_type = BodyType::JSON;
     }
     catch (const exception& e) {
@@ -139,6 +201,287 @@ void HttpRequest::ParseJsonBody()
     }
 }
 
+namespace {
+
+bool IsJsonSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void SkipJsonSpace(string_view s, size_t& i)
+{
+    while (i < s.size() && IsJsonSpace(s[i])) {
+        ++i;
+    }
+}
+
+int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// i 指向开头的引号；成功时 raw 为引号内原文，i 指向结尾引号之后
+bool ScanJsonString(string_view s, size_t& i, string_view& raw, bool& escaped)
+{
+    size_t start = ++i;
+    escaped = false;
+    while (i < s.size()) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == '"') {
+            raw = s.substr(start, i - start);
+            ++i;
+            return true;
+        }
+        if (c < 0x20) {
+            return false;
+        }
+        if (c == '\\') {
+            escaped = true;
+            if (++i >= s.size()) return false;
+            char e = s[i];
+            if (e == 'u') {
+                if (i + 4 >= s.size()) return false;
+                for (int k = 1; k <= 4; ++k) {
+                    if (HexValue(s[i + k]) < 0) return false;
+                }
+                i += 4;
+            } else if (string_view("\"\\/bfnrt").find(e) == string_view::npos) {
+                return false;
+            }
+        }
+        ++i;
+    }
+    return false;
+}
+
+// 严格校验 JSON 数字；纯整数与 dump() 输出一致，标记为 SCALAR，其余交给 DOM
+bool ScanJsonNumber(string_view s, size_t& i, bool& isInteger)
+{
+    size_t start = i;
+    if (i < s.size() && s[i] == '-') ++i;
+    if (i >= s.size()) return false;
+    if (s[i] == '0') {
+        ++i;
+    } else if (s[i] >= '1' && s[i] <= '9') {
+        while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) ++i;
+    } else {
+        return false;
+    }
+    isInteger = true;
+    if (i < s.size() && s[i] == '.') {
+        isInteger = false;
+        if (++i >= s.size() || !isdigit(static_cast<unsigned char>(s[i]))) return false;
+        while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) ++i;
+    }
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+        isInteger = false;
+        ++i;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-')) ++i;
+        if (i >= s.size() || !isdigit(static_cast<unsigned char>(s[i]))) return false;
+        while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) ++i;
+    }
+    // "-0" 经 DOM dump 后是 "0"；超出 int64 的整数 DOM 会转成浮点，都交给 DOM 处理
+    if (isInteger && (s.substr(start, i - start) == "-0" || i - start > 18)) {
+        isInteger = false;
+    }
+    return true;
+}
+
+// 跳过嵌套对象/数组，只做括号配对与字符串跳过，内部细节留给 DOM 校验
+bool SkipJsonComposite(string_view s, size_t& i)
+{
+    int depth = 0;
+    while (i < s.size()) {
+        char c = s[i];
+        if (c == '"') {
+            string_view raw;
+            bool escaped;
+            if (!ScanJsonString(s, i, raw, escaped)) return false;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                ++i;
+                return true;
+            }
+        }
+        ++i;
+    }
+    return false;
+}
+
+void AppendUtf8(string& out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+/*
+    单遍扫描顶层对象，只记录字段位置，不分配内存：
+    {"username": "tom", "password": "p\"wd", "extra": {...}}
+      → username: STRING "tom"
+      → password: ESCAPED_STRING p\"wd（取值时才解码）
+      → extra:    COMPLEX（取值时回退到 DOM）
+    顶层不是对象、字段超过 kMaxScannedFields 或语法错误时返回 false，由调用方回退到 DOM 解析
+*/
+bool HttpRequest::ScanJsonBody()
+{
+    string_view s(body);
+    size_t i = 0;
+    json_field_count = 0;
+
+    SkipJsonSpace(s, i);
+    if (i >= s.size() || s[i] != '{') return false;
+    ++i;
+    SkipJsonSpace(s, i);
+    if (i < s.size() && s[i] == '}') {
+        ++i;
+    } else {
+        while (true) {
+            if (json_field_count >= kMaxScannedFields) return false;
+            if (i >= s.size() || s[i] != '"') return false;
+
+            JsonField& field = json_fields[json_field_count];
+            bool escaped = false;
+            if (!ScanJsonString(s, i, field.key, escaped) || escaped) {
+                return false; // 带转义的键名极少见，直接走 DOM
+            }
+            SkipJsonSpace(s, i);
+            if (i >= s.size() || s[i] != ':') return false;
+            ++i;
+            SkipJsonSpace(s, i);
+            if (i >= s.size()) return false;
+
+            size_t valueStart = i;
+            char c = s[i];
+            if (c == '"') {
+                if (!ScanJsonString(s, i, field.raw, escaped)) return false;
+                field.kind = escaped ? JsonValueKind::ESCAPED_STRING : JsonValueKind::STRING;
+            } else if (c == '{' || c == '[') {
+                if (!SkipJsonComposite(s, i)) return false;
+                field.raw = s.substr(valueStart, i - valueStart);
+                field.kind = JsonValueKind::COMPLEX;
+            } else if (c == '-' || isdigit(static_cast<unsigned char>(c))) {
+                bool isInteger = false;
+                if (!ScanJsonNumber(s, i, isInteger)) return false;
+                field.raw = s.substr(valueStart, i - valueStart);
+                field.kind = isInteger ? JsonValueKind::SCALAR : JsonValueKind::COMPLEX;
+            } else {
+                static const string_view kLiterals[] = {"true", "false", "null"};
+                bool matched = false;
+                for (auto lit : kLiterals) {
+                    if (s.substr(i, lit.size()) == lit) {
+                        i += lit.size();
+                        matched = true;
+                        break;
+                    }
+                }
+                if (!matched) return false;
+                field.raw = s.substr(valueStart, i - valueStart);
+                field.kind = JsonValueKind::SCALAR;
+            }
+            ++json_field_count;
+
+            SkipJsonSpace(s, i);
+            if (i < s.size() && s[i] == ',') {
+                ++i;
+                SkipJsonSpace(s, i);
+                continue;
+            }
+            if (i < s.size() && s[i] == '}') {
+                ++i;
+                break;
+            }
+            return false;
+        }
+    }
+
+    SkipJsonSpace(s, i);
+    if (i != s.size()) return false;
+
+    body_type = BodyType::JSON;
+    return true;
+}
+
+const HttpRequest::JsonField* HttpRequest::FindJsonField(string_view key) const
+{
+    // 重复键以最后一个为准，与 nlohmann::json 一致
+    for (size_t i = json_field_count; i > 0; --i) {
+        if (json_fields[i - 1].key == key) {
+            return &json_fields[i - 1];
+        }
+    }
+    return nullptr;
+}
+
+bool HttpRequest::UnescapeJsonString(string_view raw, string& out)
+{
+    out.clear();
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++i >= raw.size()) return false;
+        switch (raw[i]) {
+        case '"':  out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/':  out += '/'; break;
+        case 'b':  out += '\b'; break;
+        case 'f':  out += '\f'; break;
+        case 'n':  out += '\n'; break;
+        case 'r':  out += '\r'; break;
+        case 't':  out += '\t'; break;
+        case 'u': {
+            if (i + 4 >= raw.size()) return false;
+            uint32_t cp = 0;
+            for (int k = 1; k <= 4; ++k) {
+                cp = (cp << 4) | static_cast<uint32_t>(HexValue(raw[i + k]));
+            }
+            i += 4;
+            // 代理对：\uD83D\uDE00
+            if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                uint32_t low = 0;
+                for (int k = 3; k <= 6; ++k) {
+                    low = (low << 4) | static_cast<uint32_t>(HexValue(raw[i + k]));
+                }
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+            AppendUtf8(out, cp);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
 void HttpRequest::ParseFormBody()
 {
     string data = body;
@@ -185,7 +528,10 @@ void HttpRequest::ParseBody()
     string contentType = Trim(headers["Content-Type"]);
 
     if (contentType.find("application/json") != string::npos) {
-        ParseJsonBody();
+        // 先按需扫描，扫不动（非对象、字段过多、语法错误）再构造 DOM
+        if (!ScanJsonBody()) {
+            ParseJsonBody();
+        }
     } else {
         ParseFormBody();
     }
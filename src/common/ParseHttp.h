@@ -1,7 +1,10 @@
 #ifndef PARSE_HTTP_H
 #define PARSE_HTTP_H
 
+#include <array>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include "json.hpp"
 enum class BodyType {
@@ -15,13 +18,31 @@ public:
     ~HttpRequest() = default;
 
     bool isValid() const { return !method.empty() && !path.empty(); }
-    std::string getMethod() const { return method; }
-    std::string getPath() const { return path; }
+    const std::string& getMethod() const { return method; }
+    const std::string& getPath() const { return path; }
     std::string getHeader(const std::string& key) const;
     
     std::string getParam(const std::string& key);
+    // 不拷贝的版本：JSON 字符串无转义时直接指向 body，有转义时才解码到请求内部的存储里
+    // 返回值的生命周期与 HttpRequest 相同
+    std::string_view getParamView(std::string_view key);
     const nlohmann::json& getJson();
 private:
+    // JSON 请求体按需解析：只扫描一遍顶层对象，记录每个字段在 body 中的位置，
+    // 真正需要 DOM（getJson 或嵌套值）时才调用 nlohmann::json::parse
+    enum class JsonValueKind : uint8_t {
+        STRING,         // 不含转义的字符串，raw 即内容
+        ESCAPED_STRING, // 含转义的字符串，raw 为引号内原文
+        SCALAR,         // 整数 / true / false / null，raw 与 dump() 结果一致
+        COMPLEX         // 对象、数组、小数等，需要 DOM
+    };
+    struct JsonField {
+        std::string_view key;
+        std::string_view raw;
+        JsonValueKind kind;
+    };
+    static constexpr size_t kMaxScannedFields = 16;
+
     bool body_parsed = false;
     std::string method;
     std::string path;
@@ -30,10 +51,17 @@ private:
     BodyType body_type = BodyType::NONE;
     std::string body;
     nlohmann::json json_body;
+    bool json_dom_built = false;
+    std::array<JsonField, kMaxScannedFields> json_fields{};
+    size_t json_field_count = 0;
+    std::deque<std::string> unescaped_values; // getParamView 解码结果，deque 保证引用稳定
     std::unordered_map<std::string, std::string> form_body;
 
     void ParseBody();
     void ParseJsonBody();
+    bool ScanJsonBody();
+    const JsonField* FindJsonField(std::string_view key) const;
+    static bool UnescapeJsonString(std::string_view raw, std::string& out);
     void ParseFormBody();
     static std::string UrlDecode(const std::string& str);
     static std::string Trim(const std::string& s);
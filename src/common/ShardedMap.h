@@ -0,0 +1,132 @@
+#ifndef SHARDED_MAP_H
+#define SHARDED_MAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+/*
+    按键哈希分片的并发哈希表，每个分片一把读写锁：
+    - 读（find）只拿共享锁，不同分片之间互不阻塞
+    - 遍历/清理按分片进行，同一时刻最多持有一个分片的锁，不会像全表大锁那样卡住所有查询
+    V 通常是 shared_ptr，find 把值拷贝出去，调用方拿到后不再依赖锁
+*/
+template <typename K, typename V, typename Hash = std::hash<K>, size_t kShards = 16>
+class ShardedMap {
+    static_assert((kShards & (kShards - 1)) == 0, "kShards must be a power of two");
+
+public:
+    static constexpr size_t shardCount() { return kShards; }
+
+    void insertOrAssign(const K& key, V value) {
+        Shard& s = shardFor(key);
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        s.map.insert_or_assign(key, std::move(value));
+    }
+
+    // 键已存在时不覆盖，返回 false
+    bool insert(const K& key, V value) {
+        Shard& s = shardFor(key);
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        return s.map.emplace(key, std::move(value)).second;
+    }
+
+    // 写入新值并在同一把锁内取出旧值（没有旧值返回 false），用于"换成新的、再处理被换下来的"
+    bool exchange(const K& key, V value, V& old) {
+        Shard& s = shardFor(key);
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) {
+            s.map.emplace(key, std::move(value));
+            return false;
+        }
+        old = std::move(it->second);
+        it->second = std::move(value);
+        return true;
+    }
+
+    bool find(const K& key, V& out) const {
+        const Shard& s = shardFor(key);
+        std::shared_lock<std::shared_mutex> lk(s.mu);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    bool erase(const K& key) {
+        Shard& s = shardFor(key);
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        return s.map.erase(key) > 0;
+    }
+
+    // 仅当 pred(value) 为真时删除，用于“值没被替换过才删”这类条件删除
+    template <typename Pred>
+    bool eraseIf(const K& key, Pred pred) {
+        Shard& s = shardFor(key);
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        auto it = s.map.find(key);
+        if (it == s.map.end() || !pred(it->second)) return false;
+        s.map.erase(it);
+        return true;
+    }
+
+    // 清理单个分片：满足 pred(key, value) 的条目被移除并追加到 removed（锁外再处理）
+    template <typename Pred>
+    size_t eraseIfInShard(size_t shard, Pred pred, std::vector<std::pair<K, V>>* removed = nullptr) {
+        Shard& s = shards_[shard % kShards];
+        std::unique_lock<std::shared_mutex> lk(s.mu);
+        size_t n = 0;
+        for (auto it = s.map.begin(); it != s.map.end(); ) {
+            if (pred(it->first, it->second)) {
+                if (removed) removed->emplace_back(it->first, std::move(it->second));
+                it = s.map.erase(it);
+                ++n;
+            } else {
+                ++it;
+            }
+        }
+        return n;
+    }
+
+    template <typename Fn>
+    void forEachInShard(size_t shard, Fn fn) const {
+        const Shard& s = shards_[shard % kShards];
+        std::shared_lock<std::shared_mutex> lk(s.mu);
+        for (const auto& kv : s.map) {
+            fn(kv.first, kv.second);
+        }
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& s : shards_) {
+            std::shared_lock<std::shared_mutex> lk(s.mu);
+            n += s.map.size();
+        }
+        return n;
+    }
+
+private:
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mu;
+        std::unordered_map<K, V, Hash> map;
+    };
+
+    // 用哈希高位选分片，低位留给分片内部的桶，避免两者相关
+    static size_t shardIndex(const K& key) {
+        uint64_t h = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<size_t>(h >> 32) & (kShards - 1);
+    }
+    Shard& shardFor(const K& key) { return shards_[shardIndex(key)]; }
+    const Shard& shardFor(const K& key) const { return shards_[shardIndex(key)]; }
+
+    std::array<Shard, kShards> shards_;
+};
+
+#endif // SHARDED_MAP_H
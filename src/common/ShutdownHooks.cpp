@@ -0,0 +1,26 @@
+#include "ShutdownHooks.h"
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+mutex g_hookMu;
+vector<function<void()>> g_shutdownHooks;
+
+} // namespace
+
+void AddShutdownHook(function<void()> hook)
+{
+    lock_guard<mutex> lk(g_hookMu);
+    g_shutdownHooks.push_back(std::move(hook));
+}
+
+void RunShutdownHooks()
+{
+    lock_guard<mutex> lk(g_hookMu);
+    for (auto& hook : g_shutdownHooks) {
+        hook();
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef SHUTDOWN_HOOKS_H
+#define SHUTDOWN_HOOKS_H
+
+#include <functional>
+
+// 退出钩子（如把写回队列刷进数据库），收到 SIGINT/SIGTERM 后由信号处理线程（见 SessionSnapshot.h）
+// 按注册顺序执行；之后进程直接 _Exit，不走静态析构，需要落盘的东西都要在钩子里做完
+void AddShutdownHook(std::function<void()> hook);
+void RunShutdownHooks();
+
+#endif // SHUTDOWN_HOOKS_H
@@ -0,0 +1,76 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/*
+    单层时间轮（带圈数），只在所属 EventLoop 线程里使用，不加锁：
+    - add(item, ticks) 把条目挂到 ticks 个刻度之后的槽位，O(1)
+    - tick() 由定时器每个刻度调用一次：转到下一个槽，圈数为 0 的条目进入到期队列
+    - 每次最多交给回调 maxPerTick 个到期条目，剩下的留到下个刻度，避免一次处理过多造成卡顿
+    条目本身不支持删除/调整：调用方在回调里判断条目是否真的到期（例如会话被 touch 续期），
+    没到期就按剩余时间重新 add，这样续期操作不需要碰时间轮
+*/
+template <typename T>
+class TimingWheel {
+public:
+    explicit TimingWheel(size_t slotCount = 512) : slots_(slotCount ? slotCount : 1) {}
+
+    // ticks 至少为 1：不会在当前刻度内到期
+    void add(T item, uint64_t ticks) {
+        if (ticks == 0) ticks = 1;
+        size_t n = slots_.size();
+        size_t pos = (cursor_ + ticks) % n;
+        slots_[pos].push_back(Entry{std::move(item), (ticks - 1) / n});
+        ++size_;
+    }
+
+    // 推进一个刻度，对最多 maxPerTick 个到期条目调用 onExpire(T&)，返回本次处理的数量
+    template <typename Fn>
+    size_t tick(size_t maxPerTick, Fn&& onExpire) {
+        cursor_ = (cursor_ + 1) % slots_.size();
+        auto& slot = slots_[cursor_];
+        size_t keep = 0;
+        for (size_t i = 0; i < slot.size(); ++i) {
+            if (slot[i].rounds == 0) {
+                due_.push_back(std::move(slot[i].item));
+                continue;
+            }
+            --slot[i].rounds;
+            if (keep != i) slot[keep] = std::move(slot[i]);
+            ++keep;
+        }
+        slot.erase(slot.begin() + keep, slot.end());
+
+        size_t done = 0;
+        while (done < maxPerTick && !due_.empty()) {
+            T item = std::move(due_.front());
+            due_.pop_front();
+            --size_;
+            ++done;
+            onExpire(item); // 回调里可以再 add
+        }
+        return done;
+    }
+
+    size_t size() const { return size_; }        // 含已到期但尚未处理的条目
+    size_t backlog() const { return due_.size(); } // 已到期、等待后续刻度处理的条目
+    size_t slotCount() const { return slots_.size(); }
+
+private:
+    struct Entry {
+        T item;
+        uint64_t rounds; // 还要再转几圈
+    };
+
+    std::vector<std::vector<Entry>> slots_;
+    std::deque<T> due_;
+    size_t cursor_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // TIMING_WHEEL_H
@@ -1,22 +1,96 @@
 #include "http_response.h"
+#include <charconv>
+#include <cstring>
+#include <ctime>
 
-const std::string& status_text(int code)
+namespace {
+
+constexpr int kMaxStatusCode = 600;
+
+struct StatusEntry {
+    int code;
+    const char* text;
+};
+
+constexpr StatusEntry kStatusEntries[] = {
+    {200, "OK"},
+    {201, "Created"},
+    {204, "No Content"},
+    {400, "Bad Request"},
+    {401, "Unauthorized"},
+    {403, "Forbidden"},
+    {404, "Not Found"},
+    {405, "Method Not Allowed"},
+    {409, "Conflict"},
+    {500, "Internal Server Error"},
+    {502, "Bad Gateway"},
+    {503, "Service Unavailable"},
+};
+
+// 预渲染的 "HTTP/1.1 200 OK\r\n"，按状态码直接下标访问
+struct StatusTable {
+    std::array<std::string, kMaxStatusCode> text;
+    std::array<std::string, kMaxStatusCode> line;
+
+    StatusTable() {
+        for (const auto& e : kStatusEntries) {
+            text[e.code] = e.text;
+            line[e.code] = "HTTP/1.1 " + std::to_string(e.code) + " " + e.text + "\r\n";
+        }
+    }
+};
+
+const StatusTable& statusTable()
+{
+    static const StatusTable table;
+    return table;
+}
+
+std::string_view contentTypeLine(ContentType type)
 {
-    static const std::unordered_map<int, std::string> kStatusText = {
-        {200, "OK"},
-        {201, "Created"},
-        {204, "No Content"},
-        {400, "Bad Request"},
-        {401, "Unauthorized"},
-        {403, "Forbidden"},
-        {404, "Not Found"},
-        {500, "Internal Server Error"},
-        {502, "Bad Gateway"},
-        {503, "Service Unavailable"},
+    switch (type) {
+    case ContentType::JSON:         return "Content-Type: application/json; charset=utf-8\r\n";
+    case ContentType::TEXT:         return "Content-Type: text/plain; charset=utf-8\r\n";
+    case ContentType::HTML:         return "Content-Type: text/html; charset=utf-8\r\n";
+    case ContentType::OCTET_STREAM: return "Content-Type: application/octet-stream\r\n";
+    }
+    return "Content-Type: application/octet-stream\r\n";
+}
+
+constexpr std::string_view kKeepAliveLine = "Connection: keep-alive\r\n";
+constexpr std::string_view kCloseLine = "Connection: close\r\n";
+constexpr std::string_view kContentLengthPrefix = "Content-Length: ";
+constexpr std::string_view kCRLF = "\r\n";
+
+// 每个线程缓存一份 Date 头，秒级变化时才重新格式化
+std::string_view cachedDateLine()
+{
+    struct DateCache {
+        std::time_t second = -1;
+        char buf[64];
+        size_t len = 0;
     };
-    auto it = kStatusText.find(code);
+    thread_local DateCache cache;
+
+    std::time_t now = std::time(nullptr);
+    if (now != cache.second) {
+        std::tm tmUtc;
+        gmtime_r(&now, &tmUtc);
+        cache.len = std::strftime(cache.buf, sizeof(cache.buf), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tmUtc);
+        cache.second = now;
+    }
+    return std::string_view(cache.buf, cache.len);
+}
+
+} // namespace
+
+const std::string& status_text(int code)
+{
     static const std::string kUnknown = "Unknown";
-    return (it != kStatusText.end()) ? it->second : kUnknown;
+    if (code < 0 || code >= kMaxStatusCode || statusTable().text[code].empty()) {
+        return kUnknown;
+    }
+    return statusTable().text[code];
 }
 
 static bool write_all(int fd, const char* data, size_t len)
@@ -38,43 +112,93 @@ static bool write_all(int fd, const char* data, size_t len)
     return true;
 }
 
+HttpResponseBuilder& HttpResponseBuilder::header(std::string_view key, std::string_view value)
+{
+    if (extraCount_ < kInlineExtraHeaders) {
+        extraHeaders_[extraCount_++] = {key, value};
+    } else {
+        overflowHeaders_.emplace_back(key, value);
+    }
+    return *this;
+}
+
+std::string HttpResponseBuilder::build(std::string_view body) const
+{
+    std::string resp;
+    buildInto(resp, body);
+    return resp;
+}
+
+void HttpResponseBuilder::buildInto(std::string& out, std::string_view body) const
+{
+    // 1. 起始行：常见状态码直接取预渲染结果
+    std::string unknownLine;
+    std::string_view statusLine;
+    if (statusCode_ >= 0 && statusCode_ < kMaxStatusCode && !statusTable().line[statusCode_].empty()) {
+        statusLine = statusTable().line[statusCode_];
+    } else {
+        unknownLine = "HTTP/1.1 " + std::to_string(statusCode_) + " Unknown\r\n";
+        statusLine = unknownLine;
+    }
+
+    char lenBuf[24];
+    auto lenEnd = std::to_chars(lenBuf, lenBuf + sizeof(lenBuf), body.size()).ptr;
+    std::string_view lenDigits(lenBuf, static_cast<size_t>(lenEnd - lenBuf));
+
+    std::string_view typeLine = contentTypeLine(contentType_);
+    std::string_view connLine = keepAlive_ ? kKeepAliveLine : kCloseLine;
+    std::string_view dateLine = cachedDateLine();
+
+    // 2. 一次算出总长度，只 reserve 一次
+    size_t total = statusLine.size() + dateLine.size() + typeLine.size()
+                 + kContentLengthPrefix.size() + lenDigits.size() + kCRLF.size()
+                 + connLine.size() + kCRLF.size() + body.size();
+    auto headerSize = [](const HeaderField& h) { return h.first.size() + 2 + h.second.size() + kCRLF.size(); };
+    for (size_t i = 0; i < extraCount_; ++i) {
+        total += headerSize(extraHeaders_[i]);
+    }
+    for (const auto& h : overflowHeaders_) {
+        total += headerSize(h);
+    }
+    out.reserve(out.size() + total);
+
+    // 3. 顺序拷贝
+    out.append(statusLine);
+    out.append(dateLine);
+    out.append(typeLine);
+    out.append(kContentLengthPrefix);
+    out.append(lenDigits);
+    out.append(kCRLF);
+    out.append(connLine);
+    auto appendHeader = [&out](const HeaderField& h) {
+        out.append(h.first);
+        out.append(": ");
+        out.append(h.second);
+        out.append(kCRLF);
+    };
+    for (size_t i = 0; i < extraCount_; ++i) {
+        appendHeader(extraHeaders_[i]);
+    }
+    for (const auto& h : overflowHeaders_) {
+        appendHeader(h);
+    }
+    out.append(kCRLF);
+    out.append(body);
+}
+
 bool send_json_response(int client_fd, int statusCode, const json& bodyJson, bool keepAlive,
     const std::vector<std::pair<std::string, std::string>>& extraHeaders)
 {
     // 1. 序列化 JSON
     std::string body = bodyJson.dump();  // 如需美化，可 dump(4)
 
-    // 2. 预估响应大小，减少 realloc
-    std::string resp;
-    resp.reserve(128 + body.size());
-
-    // 3. 起始行
-    resp += "HTTP/1.1 ";
-    resp += std::to_string(statusCode);
-    resp += " ";
-    resp += status_text(statusCode);
-    resp += "\r\n";
-
-    // 4. 必要头
-    resp += "Content-Type: application/json; charset=utf-8\r\n";
-    resp += "Content-Length: ";
-    resp += std::to_string(body.size());
-    resp += "\r\n";
-    resp += "Connection: ";
-    resp += (keepAlive ? "keep-alive" : "close");
-    resp += "\r\n";
-
-    // 5. 自定义头
+    // 2. 固定头部走预渲染，自定义头追加在后面
+    HttpResponseBuilder builder(statusCode);
+    builder.contentType(ContentType::JSON).keepAlive(keepAlive);
     for (const auto& kv : extraHeaders) {
-        resp += kv.first;
-        resp += ": ";
-        resp += kv.second;
-        resp += "\r\n";
+        builder.header(kv.first, kv.second);
     }
 
-    // 6. 头结束 + body
-    resp += "\r\n";
-    resp += body;
-
+    std::string resp = builder.build(body);
     return write_all(client_fd, resp.data(), resp.size());
-}
\ No newline at end of file
+}
@@ -1,7 +1,9 @@
 #ifndef HTTP_RESPONSE_H
 #define HTTP_RESPONSE_H
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include <unordered_map>
@@ -9,7 +11,7 @@
 #include <errno.h>
 
 #include <json.hpp>
- 
+
 /*
     sendMsg()
     ↓
@@ -26,7 +28,47 @@
 using json = nlohmann::json;
 const std::string& status_text(int code);
 
+enum class ContentType {
+    JSON,
+    TEXT,
+    HTML,
+    OCTET_STREAM
+};
+
+/*
+    HTTP 响应构造器：
+    - 状态行、Content-Type、Connection 等固定头部预先渲染好，构造时只做 memcpy
+    - Date 头每个线程缓存一份，每秒最多刷新一次（EventLoop 线程各自独立）
+    - build 先算出总长度再一次性 reserve，头部和 body 写进同一块连续内存
+    header() 只保存 string_view，调用方保证 build 之前 key/value 仍然有效；
+    前 kInlineExtraHeaders 个放在对象内的定长数组里，更多的溢出到堆上，不会丢头
+*/
+class HttpResponseBuilder {
+public:
+    static constexpr size_t kInlineExtraHeaders = 8;
+
+    explicit HttpResponseBuilder(int statusCode = 200) : statusCode_(statusCode) {}
+
+    HttpResponseBuilder& status(int code) { statusCode_ = code; return *this; }
+    HttpResponseBuilder& contentType(ContentType type) { contentType_ = type; return *this; }
+    HttpResponseBuilder& keepAlive(bool on) { keepAlive_ = on; return *this; }
+    HttpResponseBuilder& header(std::string_view key, std::string_view value);
+
+    std::string build(std::string_view body) const;
+    void buildInto(std::string& out, std::string_view body) const; // 追加到 out 末尾
+
+private:
+    int statusCode_;
+    ContentType contentType_ = ContentType::JSON;
+    bool keepAlive_ = true;
+    using HeaderField = std::pair<std::string_view, std::string_view>;
+
+    std::array<HeaderField, kInlineExtraHeaders> extraHeaders_{};
+    size_t extraCount_ = 0;
+    std::vector<HeaderField> overflowHeaders_; // 超过 kInlineExtraHeaders 的部分，通常为空
+};
+
 bool send_json_response(int client_fd, int statusCode, const json& bodyJson, bool keepAlive = true,
     const std::vector<std::pair<std::string, std::string>>& extraHeaders = {});
 
-#endif // HTTP_RESPONSE_H
\ No newline at end of file
+#endif // HTTP_RESPONSE_H
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "BloomFilter.h"
+
+using namespace std;
+
+TEST(BloomFilterTest, NoFalseNegatives) {
+    BloomFilter filter(10000, 0.01);
+    for (int i = 0; i < 10000; ++i) {
+        filter.add("player_" + to_string(i));
+    }
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(filter.mightContain("player_" + to_string(i)));
+    }
+}
+
+TEST(BloomFilterTest, FalsePositiveRateNearTarget) {
+    BloomFilter filter(10000, 0.01);
+    for (int i = 0; i < 10000; ++i) {
+        filter.add("player_" + to_string(i));
+    }
+    int falsePositives = 0;
+    const int probes = 100000;
+    for (int i = 0; i < probes; ++i) {
+        falsePositives += filter.mightContain("bot_" + to_string(i)) ? 1 : 0;
+    }
+    EXPECT_LT(falsePositives, probes * 2 / 100); // 目标 1%，留一倍余量
+}
+
+TEST(BloomFilterTest, EmptyFilterContainsNothing) {
+    BloomFilter filter(100, 0.01);
+    EXPECT_FALSE(filter.mightContain(""));
+    EXPECT_FALSE(filter.mightContain("alice"));
+    EXPECT_GE(filter.hashCount(), 1u);
+}
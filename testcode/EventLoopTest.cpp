@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include "EventLoop.h"
+#include "Client.h"
+
+using namespace std;
+
+namespace {
+
+// 在独立线程上跑一个 EventLoop，挂一条 socketpair 连接；peer 端由测试直接读
+class EventLoopTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        int sv[2];
+        ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sv), 0);
+        peer = sv[1];
+        client = make_shared<Client>(sv[0]);
+
+        promise<EventLoop*> ready;
+        loopThread = thread([&ready]() {
+            EventLoop eventLoop;
+            ready.set_value(&eventLoop);
+            eventLoop.loop();
+        });
+        loop = ready.get_future().get();
+        loop->addClient(client);
+    }
+
+    void TearDown() override {
+        loop->quit();
+        loopThread.join();
+        ::close(peer);
+    }
+
+    bool Send(uint64_t connId, const string& data) {
+        auto done = make_shared<promise<bool>>();
+        auto result = done->get_future();
+        loop->sendToClientWithResult(client->getFd(), connId, data, [done](bool ok) { done->set_value(ok); });
+        return result.get();
+    }
+
+    bool Registered() {
+        promise<bool> found;
+        int fd = client->getFd();
+        loop->runInLoop([this, fd, &found]() { found.set_value(loop->getClient(fd) != nullptr); });
+        return found.get_future().get();
+    }
+
+    string ReadPeer() {
+        char buf[256];
+        ssize_t n = ::recv(peer, buf, sizeof(buf), MSG_DONTWAIT);
+        return n > 0 ? string(buf, static_cast<size_t>(n)) : string();
+    }
+
+    EventLoop* loop = nullptr;
+    thread loopThread;
+    shared_ptr<Client> client;
+    int peer = -1;
+};
+
+} // namespace
+
+TEST_F(EventLoopTest, SendToStaleConnIdIsDropped) {
+    // fd 被复用给了新连接：按旧 connId 投递的数据不能写给它
+    EXPECT_FALSE(Send(client->getConnId() + 1000, "stale"));
+    EXPECT_EQ(ReadPeer(), "");
+
+    EXPECT_TRUE(Send(client->getConnId(), "hello"));
+    EXPECT_EQ(ReadPeer(), "hello");
+}
+
+TEST_F(EventLoopTest, RemoveByStaleConnIdKeepsClient) {
+    loop->removeClient(client->getFd(), client->getConnId() + 1000);
+    EXPECT_TRUE(Registered());
+
+    loop->removeClient(client->getFd(), client->getConnId());
+    EXPECT_FALSE(Registered());
+}
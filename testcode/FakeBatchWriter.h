@@ -0,0 +1,39 @@
+#ifndef FAKE_BATCH_WRITER_H
+#define FAKE_BATCH_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "WriteBehindStore.h"
+
+// 测试用的 WriteBehindStore 写入端：记录每一批写入，可以切换成失败模式
+struct FakeWriter {
+    std::mutex mu;
+    std::vector<std::vector<RowImage>> batches;
+    std::atomic<bool> failing{false};
+
+    WriteBehindStore::BatchWriter writer() {
+        return [this](const TableSchema&, const std::vector<RowImage>& rows) {
+            if (failing) return false;
+            std::lock_guard<std::mutex> lk(mu);
+            batches.push_back(rows);
+            return true;
+        };
+    }
+
+    size_t rows() {
+        std::lock_guard<std::mutex> lk(mu);
+        size_t n = 0;
+        for (auto& b : batches) n += b.size();
+        return n;
+    }
+};
+
+// 刷新间隔足够长，测试里由 flush() 显式触发
+inline WriteBehindStore::Options ManualOptions(size_t batchRows = 100, size_t maxPending = 1000)
+{
+    return WriteBehindStore::Options{std::chrono::hours(1), batchRows, maxPending};
+}
+
+#endif // FAKE_BATCH_WRITER_H
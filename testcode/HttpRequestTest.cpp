@@ -23,8 +23,8 @@ TEST_F(HttpRequestTest, ParseJsonRequest) {
 
     HttpRequest http(req);
 
-    EXPECT_EQ(http.method, "POST");
-    EXPECT_EQ(http.path, "/order/create");
+    EXPECT_EQ(http.getMethod(), "POST");
+    EXPECT_EQ(http.getPath(), "/order/create");
 
     EXPECT_EQ(http.getHeader("Host"), " api.example.com");
     EXPECT_EQ(http.getHeader("Authorization"), " Bearer token123");
@@ -51,8 +51,8 @@ TEST_F(HttpRequestTest, ParseFormRequest) {
 
     HttpRequest http(req);
 
-    EXPECT_EQ(http.method, "POST");
-    EXPECT_EQ(http.path, "/submit");
+    EXPECT_EQ(http.getMethod(), "POST");
+    EXPECT_EQ(http.getPath(), "/submit");
 
     EXPECT_EQ(http.getHeader("Content-Type"), " application/x-www-form-urlencoded");
 
@@ -64,3 +64,63 @@ TEST_F(HttpRequestTest, ParseFormRequest) {
     const auto& j = http.getJson();
     EXPECT_TRUE(j.is_null() || j.empty());
 }
+
+TEST_F(HttpRequestTest, OnDemandJsonParamsWithoutDom) {
+    const string req =
+        "POST /api/login HTTP/1.1\r\n"
+        "Content-Type: application/json\r\n"
+        "\r\n"
+        "{ \"username\" : \"tom\", \"password\": \"p\\\"w\\\\d\\u4e2d\", \"level\": -12, \"vip\": true }";
+
+    HttpRequest http(req);
+
+    EXPECT_EQ(http.getParamView("username"), "tom");
+    EXPECT_EQ(http.getParam("password"), "p\"w\\d\xe4\xb8\xad");
+    EXPECT_EQ(http.getParamView("password"), "p\"w\\d\xe4\xb8\xad");
+    EXPECT_EQ(http.getParam("level"), "-12");
+    EXPECT_EQ(http.getParam("vip"), "true");
+    EXPECT_EQ(http.getParam("missing"), "");
+    // 无转义的字符串直接指向请求体，反复取是同一段内存
+    EXPECT_EQ(http.getParamView("username").data(), http.getParamView("username").data());
+
+    // 之后再要 DOM：结果与扫描一致，扫描出的字段也仍然可用
+    const auto& j = http.getJson();
+    EXPECT_EQ(j["password"].get<string>(), "p\"w\\d\xe4\xb8\xad");
+    EXPECT_EQ(j["level"].get<int>(), -12);
+    EXPECT_TRUE(j["vip"].get<bool>());
+    EXPECT_EQ(http.getParam("username"), "tom");
+    EXPECT_EQ(http.getParamView("password"), "p\"w\\d\xe4\xb8\xad");
+}
+
+TEST_F(HttpRequestTest, OnDemandJsonFallsBackForNestedValues) {
+    const string req =
+        "POST /api/x HTTP/1.1\r\n"
+        "Content-Type: application/json\r\n"
+        "\r\n"
+        "{\"name\":\"a\",\"pos\":{ \"x\": 1, \"tag\": \"}\" },\"ratio\":1.50,\"name\":\"b\"}";
+
+    HttpRequest http(req);
+
+    EXPECT_EQ(http.getParamView("name"), "b"); // 重复键取最后一个
+    // 嵌套对象和小数走 DOM，按 dump() 的规范形式返回
+    EXPECT_EQ(http.getParam("pos"), "{\"tag\":\"}\",\"x\":1}");
+    EXPECT_EQ(http.getParamView("pos"), "{\"tag\":\"}\",\"x\":1}");
+    EXPECT_EQ(http.getParam("ratio"), "1.5");
+    // 构造过 DOM 之后，扫描结果和 DOM 对重复键的取舍一致
+    EXPECT_EQ(http.getParamView("name"), "b");
+    EXPECT_EQ(http.getJson()["name"].get<string>(), "b");
+}
+
+TEST_F(HttpRequestTest, MalformedJsonYieldsEmptyParams) {
+    const string req =
+        "POST /api/login HTTP/1.1\r\n"
+        "Content-Type: application/json\r\n"
+        "\r\n"
+        "{\"username\":\"tom\",\"password\":}";
+
+    HttpRequest http(req);
+
+    EXPECT_EQ(http.getParam("username"), "");
+    EXPECT_TRUE(http.getParamView("username").empty());
+    EXPECT_TRUE(http.getJson().is_null());
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "http_response.h"
+
+using namespace std;
+
+TEST(HttpResponseBuilderTest, BuildJsonResponse) {
+    const string body = "{\"status\":\"ok\"}";
+    string resp = HttpResponseBuilder(200).keepAlive(true).build(body);
+
+    EXPECT_EQ(resp.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    EXPECT_NE(resp.find("\r\nDate: "), string::npos);
+    EXPECT_NE(resp.find("\r\nContent-Type: application/json; charset=utf-8\r\n"), string::npos);
+    EXPECT_NE(resp.find("\r\nContent-Length: 15\r\n"), string::npos);
+    EXPECT_NE(resp.find("\r\nConnection: keep-alive\r\n"), string::npos);
+
+    size_t headerEnd = resp.find("\r\n\r\n");
+    ASSERT_NE(headerEnd, string::npos);
+    EXPECT_EQ(resp.substr(headerEnd + 4), body);
+}
+
+TEST(HttpResponseBuilderTest, ExtraHeadersAndNonJsonBody) {
+    string resp = HttpResponseBuilder(503)
+        .contentType(ContentType::TEXT)
+        .keepAlive(false)
+        .header("Retry-After", "1")
+        .build("busy");
+
+    EXPECT_EQ(resp.rfind("HTTP/1.1 503 Service Unavailable\r\n", 0), 0u);
+    EXPECT_NE(resp.find("\r\nContent-Type: text/plain; charset=utf-8\r\n"), string::npos);
+    EXPECT_NE(resp.find("\r\nConnection: close\r\n"), string::npos);
+    EXPECT_NE(resp.find("\r\nRetry-After: 1\r\n\r\nbusy"), string::npos);
+}
+
+TEST(HttpResponseBuilderTest, KeepsHeadersBeyondInlineCapacity) {
+    vector<string> names;
+    for (size_t i = 0; i < HttpResponseBuilder::kInlineExtraHeaders + 3; ++i) {
+        names.push_back("X-H" + to_string(i));
+    }
+    HttpResponseBuilder builder(200);
+    for (const auto& name : names) {
+        builder.header(name, "v");
+    }
+    string resp = builder.build("{}");
+
+    size_t pos = 0;
+    for (const auto& name : names) {
+        size_t found = resp.find("\r\n" + name + ": v\r\n", pos);
+        ASSERT_NE(found, string::npos) << name;
+        pos = found + 1; // 按添加顺序输出
+    }
+    EXPECT_NE(resp.find("\r\n\r\n{}"), string::npos);
+}
+
+TEST(HttpResponseBuilderTest, UnknownStatusCode) {
+    string resp = HttpResponseBuilder(299).build("");
+    EXPECT_EQ(resp.rfind("HTTP/1.1 299 Unknown\r\n", 0), 0u);
+    EXPECT_EQ(status_text(299), "Unknown");
+    EXPECT_EQ(status_text(404), "Not Found");
+}
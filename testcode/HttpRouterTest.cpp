@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "HttpRouter.h"
+
+using namespace std;
+
+class HttpRouterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto tag = [](int id) {
+            return [id](HttpRequest&, std::shared_ptr<Client>, const RouteParams&) {
+                return id == 1;
+            };
+        };
+        ASSERT_TRUE(router.addRoute(HttpMethod::POST, "/api/login", tag(1)));
+        ASSERT_TRUE(router.addRoute(HttpMethod::POST, "/api/register", tag(2)));
+        ASSERT_TRUE(router.addRoute(HttpMethod::GET, "/api/server/list", tag(3)));
+        ASSERT_TRUE(router.addRoute(HttpMethod::GET, "/api/server/:id", tag(4)));
+        ASSERT_TRUE(router.addRoute(HttpMethod::GET, "/api/server/:id/notice/:lang", tag(5)));
+    }
+
+    HttpRouter router;
+    const HttpRouter::Handler* handler = nullptr;
+    RouteParams params;
+};
+
+TEST_F(HttpRouterTest, MatchStaticRoute) {
+    EXPECT_EQ(router.match(HttpMethod::POST, "/api/login", handler, params), HttpRouter::MatchResult::Found);
+    ASSERT_NE(handler, nullptr);
+    EXPECT_EQ(params.size(), 0u);
+
+    EXPECT_EQ(router.match(HttpMethod::POST, "/api/login?from=web", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(router.match(HttpMethod::POST, "/api/login/", handler, params), HttpRouter::MatchResult::Found);
+}
+
+TEST_F(HttpRouterTest, StaticSegmentWinsOverParam) {
+    EXPECT_EQ(router.match(HttpMethod::GET, "/api/server/list", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.size(), 0u);
+}
+
+TEST_F(HttpRouterTest, MatchPathParams) {
+    const string path = "/api/server/42/notice/zh";
+    EXPECT_EQ(router.match(HttpMethod::GET, path, handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.size(), 2u);
+    EXPECT_EQ(params.get("id"), "42");
+    EXPECT_EQ(params.get("lang"), "zh");
+    EXPECT_TRUE(params.get("missing").empty());
+}
+
+TEST_F(HttpRouterTest, NotFoundAndMethodNotAllowed) {
+    EXPECT_EQ(router.match(HttpMethod::GET, "/api/unknown", handler, params), HttpRouter::MatchResult::NotFound);
+    EXPECT_EQ(router.match(HttpMethod::GET, "/api", handler, params), HttpRouter::MatchResult::NotFound);
+    EXPECT_EQ(router.match(HttpMethod::GET, "/api/login", handler, params), HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(router.match(HttpMethod::UNKNOWN, "/api/login", handler, params), HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(handler, nullptr);
+}
+
+TEST_F(HttpRouterTest, MethodNotAllowedListsAllowedMethods) {
+    auto h = [](HttpRequest&, std::shared_ptr<Client>, const RouteParams&) { return false; };
+    ASSERT_TRUE(router.addRoute(HttpMethod::PUT, "/api/login", h));
+    string allow;
+    EXPECT_EQ(router.match(HttpMethod::GET, "/api/login", handler, params, &allow),
+              HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(allow, "POST, PUT");
+}
+
+TEST_F(HttpRouterTest, BacktracksToParamWhenStaticBranchDeadEnds) {
+    auto tag = [](HttpRequest&, std::shared_ptr<Client>, const RouteParams&) { return true; };
+    HttpRouter r;
+    ASSERT_TRUE(r.addRoute(HttpMethod::GET, "/a/b/c", tag));
+    ASSERT_TRUE(r.addRoute(HttpMethod::GET, "/a/:x", tag));
+
+    // /a/b 是静态中间节点，没有 handler，要回溯到 /a/:x
+    EXPECT_EQ(r.match(HttpMethod::GET, "/a/b", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.get("x"), "b");
+    EXPECT_EQ(r.match(HttpMethod::GET, "/a/b/c", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.size(), 0u);
+}
+
+TEST_F(HttpRouterTest, BacktracksToParamWhenStaticRouteLacksMethod) {
+    auto tag = [](HttpRequest&, std::shared_ptr<Client>, const RouteParams&) { return true; };
+    HttpRouter r;
+    ASSERT_TRUE(r.addRoute(HttpMethod::POST, "/a/b", tag));
+    ASSERT_TRUE(r.addRoute(HttpMethod::GET, "/a/:x", tag));
+
+    EXPECT_EQ(r.match(HttpMethod::GET, "/a/b", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.get("x"), "b");
+    EXPECT_EQ(r.match(HttpMethod::POST, "/a/b", handler, params), HttpRouter::MatchResult::Found);
+    EXPECT_EQ(params.size(), 0u);
+
+    // 两条路都没有 PUT：405，Allow 合并两个节点的方法
+    string allow;
+    EXPECT_EQ(r.match(HttpMethod::PUT, "/a/b", handler, params, &allow), HttpRouter::MatchResult::MethodNotAllowed);
+    EXPECT_EQ(allow, "GET, POST");
+    EXPECT_EQ(params.size(), 0u);
+}
+
+TEST_F(HttpRouterTest, RejectDuplicateRoute) {
+    auto h = [](HttpRequest&, std::shared_ptr<Client>, const RouteParams&) { return false; };
+    EXPECT_FALSE(router.addRoute(HttpMethod::POST, "/api/login", h));
+    EXPECT_FALSE(router.addRoute(HttpMethod::GET, "/api/server/:name", h));
+    EXPECT_TRUE(router.addRoute(HttpMethod::GET, "/api/login", h));
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "JsonWriter.h"
+#include "json.hpp"
+
+using namespace std;
+
+TEST(JsonWriterTest, WriteNestedDocument) {
+    string out;
+    JsonWriter w(out);
+    w.beginObject()
+        .field("status", "success")
+        .field("count", 3)
+        .field("ratio", 0.5)
+        .field("online", true)
+        .key("items").beginArray().value(1).value("two").null().endArray()
+        .key("empty").beginObject().endObject()
+     .endObject();
+
+    EXPECT_TRUE(w.ok());
+    EXPECT_EQ(out, R"({"status":"success","count":3,"ratio":0.5,"online":true,"items":[1,"two",null],"empty":{}})");
+    EXPECT_NO_THROW(nlohmann::json::parse(out));
+}
+
+TEST(JsonWriterTest, EscapeMatchesNlohmann) {
+    const string raw = "quote\" slash\\ nl\n tab\t ctl\x01 utf8:\xe4\xb8\xad";
+    string out;
+    JsonWriter w(out);
+    w.beginObject().field("v", raw).endObject();
+
+    EXPECT_EQ(out, nlohmann::json({{"v", raw}}).dump());
+    EXPECT_EQ(nlohmann::json::parse(out)["v"].get<string>(), raw);
+}
+
+TEST(JsonWriterTest, UnbalancedIsReported) {
+    string out;
+    JsonWriter w(out);
+    w.beginObject().key("a");
+    EXPECT_FALSE(w.ok());
+}
+
+TEST(JsonTemplateTest, RenderWithEscapedSlots) {
+    JsonTemplate tpl(R"({"status":"success","token":"${}","level":${}})");
+    EXPECT_EQ(tpl.slotCount(), 2u);
+
+    string out = tpl.render({"ab\"c", "7"});
+    EXPECT_EQ(out, R"({"status":"success","token":"ab\"c","level":7})");
+
+    auto j = nlohmann::json::parse(out);
+    EXPECT_EQ(j["token"].get<string>(), "ab\"c");
+    EXPECT_EQ(j["level"].get<int>(), 7);
+}
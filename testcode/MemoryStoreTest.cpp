@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MemoryRowStore.h"
+#include "MemoryUserStore.h"
+
+using namespace std;
+
+namespace {
+
+const TableSchema& ItemTable()
+{
+    static const TableSchema table{"test_item", {"owner", "slot"}, {"item_id", "item_count"}};
+    return table;
+}
+
+RowImage Item(const string& owner, int64_t slot, int64_t itemId, int64_t count)
+{
+    return RowImage{&ItemTable(), {owner, slot}, {itemId, count}, {}};
+}
+
+} // namespace
+
+TEST(MemoryRowStoreTest, UpsertAndSelectByOwner) {
+    MemoryRowStore store;
+    ASSERT_TRUE(store.apply(ItemTable(), {Item("alice", 2, 200, 1), Item("alice", 1, 100, 5), Item("bob", 1, 300, 1)}));
+    ASSERT_TRUE(store.apply(ItemTable(), {Item("alice", 2, 200, 9)}));
+
+    auto rows = store.selectByOwner(ItemTable(), string("alice"));
+    ASSERT_EQ(rows.size(), 2u);
+    // 按其余主键升序
+    EXPECT_EQ(get<int64_t>(rows[0].keys[1]), 1);
+    EXPECT_EQ(get<int64_t>(rows[1].keys[1]), 2);
+    EXPECT_EQ(get<int64_t>(rows[1].values[1]), 9);
+    EXPECT_EQ(rows[1].table, &ItemTable());
+    EXPECT_EQ(store.rowCount(), 3u);
+    EXPECT_TRUE(store.selectByOwner(ItemTable(), string("carol")).empty());
+}
+
+TEST(MemoryRowStoreTest, PartialUpdateTouchesOnlyDirtyColumnsOfExistingRows) {
+    MemoryRowStore store;
+    store.apply(ItemTable(), {Item("alice", 1, 100, 5)});
+
+    RowImage partial = Item("alice", 1, 999, 7);
+    partial.dirty.set(1); // 只改 item_count
+    RowImage missing = Item("alice", 2, 999, 7);
+    missing.dirty.set(1);
+    store.apply(ItemTable(), {partial, missing});
+
+    auto rows = store.selectByOwner(ItemTable(), string("alice"));
+    ASSERT_EQ(rows.size(), 1u); // 同 UPDATE：不存在的行不会被创建
+    EXPECT_EQ(get<int64_t>(rows[0].values[0]), 100);
+    EXPECT_EQ(get<int64_t>(rows[0].values[1]), 7);
+}
+
+TEST(MemoryRowStoreTest, MalformedRowRejectsWholeBatch) {
+    MemoryRowStore store;
+    store.apply(ItemTable(), {Item("alice", 1, 100, 5)});
+
+    RowImage bad{&ItemTable(), {string("alice")}, {int64_t(1), int64_t(1)}, {}}; // 少一个主键列
+    EXPECT_THROW(store.apply(ItemTable(), {Item("alice", 1, 100, 6), bad, Item("bob", 1, 300, 1)}),
+                 invalid_argument);
+
+    auto rows = store.selectByOwner(ItemTable(), string("alice"));
+    ASSERT_EQ(rows.size(), 1u);
+    EXPECT_EQ(get<int64_t>(rows[0].values[1]), 5);
+    EXPECT_EQ(store.rowCount(), 1u);
+}
+
+TEST(MemoryRowStoreTest, ReadersNeverSeeHalfABatch) {
+    MemoryRowStore store;
+    store.apply(ItemTable(), {Item("alice", 1, 100, 0), Item("alice", 2, 200, 0)});
+
+    atomic<bool> done{false};
+    thread writer([&]() {
+        for (int64_t n = 1; n <= 20000; ++n) {
+            store.apply(ItemTable(), {Item("alice", 1, 100, n), Item("alice", 2, 200, n)});
+        }
+        done = true;
+    });
+    size_t torn = 0;
+    while (!done) {
+        auto rows = store.selectByOwner(ItemTable(), string("alice"));
+        if (rows.size() == 2 && get<int64_t>(rows[0].values[1]) != get<int64_t>(rows[1].values[1])) {
+            ++torn;
+        }
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0u);
+}
+
+TEST(MemoryUserStoreTest, InsertRejectsDuplicates) {
+    MemoryUserStore store;
+    CachedUserInfo info;
+    EXPECT_EQ(store.find("alice", info), UserQueryStatus::OK);
+    EXPECT_FALSE(info.exists);
+
+    EXPECT_EQ(store.insert("alice", "hash1", "inv", 1), InsertUserStatus::OK);
+    EXPECT_EQ(store.insert("alice", "hash2", "inv", 2), InsertUserStatus::DUPLICATE);
+    EXPECT_EQ(store.find("alice", info), UserQueryStatus::OK);
+    EXPECT_TRUE(info.exists);
+    EXPECT_EQ(info.pwdHash, "hash1");
+}
+
+TEST(MemoryUserStoreTest, ConcurrentSignUpsOfSameNameHaveOneWinner) {
+    MemoryUserStore store;
+    atomic<int> wins{0};
+    vector<thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&store, &wins, t]() {
+            for (int i = 0; i < 100; ++i) {
+                if (store.insert("user_" + to_string(i), "h" + to_string(t), "", 0) == InsertUserStatus::OK) {
+                    ++wins;
+                }
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(wins.load(), 100);
+
+    size_t count = 0;
+    ASSERT_TRUE(store.countUsers(count));
+    EXPECT_EQ(count, 100u);
+    set<string> names;
+    ASSERT_TRUE(store.forEachUsername([&names](const string& name) { names.insert(name); }));
+    EXPECT_EQ(names.size(), 100u);
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include "EventLoop.h"
+#include "PlayerLoader.h"
+#include "WriteBehindStore.h"
+#include "FakeBatchWriter.h"
+
+using namespace std;
+
+namespace {
+
+// 假的加载函数：按用户名造一个角色，记录被调用了几次
+struct FakeLoader {
+    atomic<int> calls{0};
+    PlayerLoadStatus status = PlayerLoadStatus::OK;
+
+    OnlinePlayers::Loader loader() {
+        return [this](const string& username, PlayerData& out, PlayerLoadTimings&) {
+            ++calls;
+            PlayerCharacter c;
+            c.username = username;
+            c.gold = 100;
+            out.character = TrackedCharacter(c);
+            return status;
+        };
+    }
+};
+
+} // namespace
+
+TEST(OnlinePlayersTest, AcquireLoadsOnceAndReusesResidentPlayer) {
+    FakeWriter fake;
+    FakeLoader loader;
+    WriteBehindStore store("test_online_acquire", fake.writer(), ManualOptions());
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> first, second;
+    PlayerLoadTimings timings;
+    ASSERT_EQ(players.acquire("alice", first, &timings), PlayerLoadStatus::OK);
+    EXPECT_FALSE(timings.resident);
+    ASSERT_EQ(players.acquire("alice", second, &timings), PlayerLoadStatus::OK);
+    EXPECT_TRUE(timings.resident);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(loader.calls, 1);
+    EXPECT_EQ(players.size(), 1u);
+    EXPECT_EQ(players.get("alice"), first);
+}
+
+TEST(OnlinePlayersTest, FailedLoadLeavesNothingResident) {
+    FakeWriter fake;
+    FakeLoader loader;
+    loader.status = PlayerLoadStatus::BUSY;
+    WriteBehindStore store("test_online_busy", fake.writer(), ManualOptions());
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> data;
+    EXPECT_EQ(players.acquire("alice", data), PlayerLoadStatus::BUSY);
+    EXPECT_EQ(players.size(), 0u);
+    EXPECT_EQ(players.get("alice"), nullptr);
+}
+
+TEST(OnlinePlayersTest, ReleaseHandsLastChangesToStore) {
+    FakeWriter fake;
+    FakeLoader loader;
+    WriteBehindStore store("test_online_release", fake.writer(), ManualOptions());
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> data;
+    ASSERT_EQ(players.acquire("alice", data), PlayerLoadStatus::OK);
+    data->character.addGold(5);
+    players.release("alice");
+    EXPECT_FALSE(data->character.hasUnsaved());
+    EXPECT_EQ(store.pendingRows(), 1u);
+
+    ASSERT_TRUE(store.flush());
+    ASSERT_EQ(fake.rows(), 1u);
+    const RowImage& row = fake.batches[0][0];
+    EXPECT_TRUE(row.isPartial());
+    EXPECT_TRUE(row.dirty.test(static_cast<size_t>(CharacterField::Gold)));
+    EXPECT_EQ(get<int64_t>(row.values[static_cast<size_t>(CharacterField::Gold)]), 105);
+}
+
+TEST(OnlinePlayersTest, SweepWaitsForCleanFlushAfterRelease) {
+    FakeWriter fake;
+    FakeLoader loader;
+    WriteBehindStore store("test_online_sweep", fake.writer(), ManualOptions());
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> data;
+    ASSERT_EQ(players.acquire("alice", data), PlayerLoadStatus::OK);
+    ASSERT_EQ(players.acquire("bob", data), PlayerLoadStatus::OK);
+    ASSERT_TRUE(store.flush()); // release 之前的 flush 不算
+    data->character.setLevel(9);
+    players.release("bob");
+
+    EXPECT_EQ(players.sweep(), 0u);
+    fake.failing = true;
+    EXPECT_FALSE(store.flush());
+    EXPECT_EQ(players.sweep(), 0u); // 失败的 flush 不推进 lastCleanFlush
+
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(players.sweep(), 1u);
+    EXPECT_EQ(players.get("bob"), nullptr);
+    EXPECT_NE(players.get("alice"), nullptr); // 在线的不清
+}
+
+TEST(OnlinePlayersTest, ReacquireCancelsRelease) {
+    FakeWriter fake;
+    FakeLoader loader;
+    WriteBehindStore store("test_online_reacquire", fake.writer(), ManualOptions());
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> first, second;
+    ASSERT_EQ(players.acquire("alice", first), PlayerLoadStatus::OK);
+    players.release("alice");
+    ASSERT_EQ(players.acquire("alice", second), PlayerLoadStatus::OK);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(loader.calls, 1);
+
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(players.sweep(), 0u);
+    EXPECT_EQ(players.get("alice"), first);
+}
+
+TEST(OnlinePlayersTest, RejectedChangesStayDirtyAndResident) {
+    FakeWriter fake;
+    FakeLoader loader;
+    // 只能排一行；写入端先失败，后台 flush 腾不出位置，第二个玩家的改动一定被拒收
+    fake.failing = true;
+    WriteBehindStore store("test_online_full", fake.writer(), ManualOptions(1, 1));
+    OnlinePlayers players(store, loader.loader());
+
+    shared_ptr<PlayerData> alice, bob;
+    ASSERT_EQ(players.acquire("alice", alice), PlayerLoadStatus::OK);
+    ASSERT_EQ(players.acquire("bob", bob), PlayerLoadStatus::OK);
+    alice->character.setExp(1);
+    bob->character.setExp(2);
+
+    EXPECT_EQ(players.saveDirty(), 1u);
+    ASSERT_NE(alice->character.hasUnsaved(), bob->character.hasUnsaved());
+    auto& pending = alice->character.hasUnsaved() ? alice : bob;
+    const string pendingName = pending == alice ? "alice" : "bob";
+
+    // 被拒收的玩家下线：改动还在对象上，之后的成功 flush 也不能让 sweep 丢掉它
+    players.release(pendingName);
+    EXPECT_TRUE(pending->character.hasUnsaved());
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(players.sweep(), 0u);
+
+    // 有空位后 saveDirty 补交并重新计时：补交之前开始的 flush 不算
+    fake.failing = true;
+    EXPECT_EQ(players.saveDirty(), 1u);
+    EXPECT_FALSE(pending->character.hasUnsaved());
+    EXPECT_EQ(players.sweep(), 0u);
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(players.sweep(), 1u);
+    EXPECT_EQ(players.get(pendingName), nullptr);
+    EXPECT_EQ(fake.rows(), 2u);
+}
+
+TEST(OnlinePlayersTest, ShutdownSavesDirtyPlayersOnLoopBeforeStop) {
+    FakeWriter fake;
+    FakeLoader loader;
+    WriteBehindStore store("test_online_shutdown", fake.writer(), ManualOptions(1, 1));
+    OnlinePlayers players(store, loader.loader());
+
+    promise<EventLoop*> ready;
+    thread loopThread([&ready]() {
+        EventLoop loop;
+        ready.set_value(&loop);
+        loop.loop();
+    });
+    EventLoop* loop = ready.get_future().get();
+
+    shared_ptr<PlayerData> alice, bob;
+    ASSERT_EQ(players.acquire("alice", alice), PlayerLoadStatus::OK);
+    ASSERT_EQ(players.acquire("bob", bob), PlayerLoadStatus::OK);
+
+    // 写入端失败时 alice 占住唯一的名额，bob 的改动被拒收，留在对象上
+    fake.failing = true;
+    alice->character.setGold(7);
+    EXPECT_EQ(players.saveDirty(), 1u);
+    EXPECT_FALSE(store.flush());
+    bob->character.setGold(8);
+    EXPECT_EQ(players.saveDirty(), 0u);
+    EXPECT_TRUE(bob->character.hasUnsaved());
+
+    // 与 main 里的退出钩子相同的顺序：loop 上交出脏字段，再停存储做最后一次 flush
+    fake.failing = false;
+    EXPECT_EQ(players.saveOnShutdown(loop, chrono::seconds(5)), 1u);
+    store.stop();
+    loop->quit();
+    loopThread.join();
+
+    EXPECT_FALSE(bob->character.hasUnsaved());
+    EXPECT_EQ(store.pendingRows(), 0u);
+    ASSERT_EQ(fake.rows(), 2u);
+    for (const auto& batch : fake.batches) {
+        for (const auto& row : batch) {
+            const string& name = get<string>(row.keys[0]);
+            EXPECT_EQ(get<int64_t>(row.values[static_cast<size_t>(CharacterField::Gold)]), name == "alice" ? 7 : 8);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "PlayerTables.h"
+
+using namespace std;
+
+namespace {
+
+PlayerCharacter Character(const string& username)
+{
+    PlayerCharacter c;
+    c.username = username;
+    c.level = 3;
+    c.gold = 100;
+    return c;
+}
+
+size_t Index(CharacterField field)
+{
+    return static_cast<size_t>(field);
+}
+
+} // namespace
+
+TEST(TrackedCharacterTest, UnchangedCharacterHasNoRow)
+{
+    TrackedCharacter c(Character("alice"));
+    c.setGold(100); // 值没变不算脏
+    RowImage row;
+    EXPECT_FALSE(c.takeDirtyRow(row));
+    EXPECT_FALSE(c.hasUnsaved());
+}
+
+TEST(TrackedCharacterTest, TakeDirtyRowCarriesOnlyChangedColumns)
+{
+    TrackedCharacter c(Character("alice"));
+    c.addGold(50);
+    c.setPosition(1.5, 2.5);
+
+    RowImage row;
+    ASSERT_TRUE(c.takeDirtyRow(row));
+    EXPECT_TRUE(row.isPartial());
+    EXPECT_EQ(row.table, &PlayerCharacterTable());
+    ASSERT_EQ(row.keys.size(), 1u);
+    EXPECT_EQ(get<string>(row.keys[0]), "alice");
+    EXPECT_TRUE(row.dirty.test(Index(CharacterField::Gold)));
+    EXPECT_TRUE(row.dirty.test(Index(CharacterField::PosX)));
+    EXPECT_TRUE(row.dirty.test(Index(CharacterField::PosY)));
+    EXPECT_FALSE(row.dirty.test(Index(CharacterField::Level)));
+    EXPECT_EQ(get<int64_t>(row.values[Index(CharacterField::Gold)]), 150);
+
+    // 取走后脏位清空
+    EXPECT_FALSE(c.hasUnsaved());
+    EXPECT_FALSE(c.takeDirtyRow(row));
+}
+
+TEST(TrackedCharacterTest, RestoreDirtyMergesWithNewerChanges)
+{
+    TrackedCharacter c(Character("alice"));
+    c.setGold(10);
+    RowImage rejected;
+    ASSERT_TRUE(c.takeDirtyRow(rejected));
+
+    // 存储拒收的同时又改了别的列，两部分都要在下一次取出来
+    c.setLevel(4);
+    c.restoreDirty(rejected);
+    EXPECT_TRUE(c.hasUnsaved());
+
+    RowImage row;
+    ASSERT_TRUE(c.takeDirtyRow(row));
+    EXPECT_TRUE(row.dirty.test(Index(CharacterField::Gold)));
+    EXPECT_TRUE(row.dirty.test(Index(CharacterField::Level)));
+    EXPECT_EQ(get<int64_t>(row.values[Index(CharacterField::Gold)]), 10);
+    EXPECT_EQ(get<int64_t>(row.values[Index(CharacterField::Level)]), 4);
+}
+
+TEST(TrackedCharacterTest, UnsavedCharacterYieldsFullRowUntilAccepted)
+{
+    TrackedCharacter c(Character("bob"));
+    c.markUnsaved();
+    EXPECT_TRUE(c.hasUnsaved());
+
+    RowImage row;
+    ASSERT_TRUE(c.takeDirtyRow(row));
+    EXPECT_FALSE(row.isPartial());
+
+    // 建档的整行被拒收：之后的改动也并进下一次的整行，而不是变成找不到行的 UPDATE
+    c.restoreDirty(row);
+    c.setExp(7);
+    ASSERT_TRUE(c.takeDirtyRow(row));
+    EXPECT_FALSE(row.isPartial());
+    EXPECT_EQ(get<int64_t>(row.values[Index(CharacterField::Exp)]), 7);
+    EXPECT_FALSE(c.hasUnsaved());
+
+    c.setExp(8);
+    ASSERT_TRUE(c.takeDirtyRow(row));
+    EXPECT_TRUE(row.isPartial());
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "SessionAttrs.h"
+
+using namespace std;
+
+TEST(SessionAttrsTest, TypedGetSet) {
+    SessionAttrs attrs;
+    attrs.set(SessionAttr::CharacterId, 10001);
+    attrs.set(SessionAttr::IsGm, true);
+    attrs.set(SessionAttr::ClientVersion, "1.2.3");
+
+    int64_t id = 0;
+    bool gm = false;
+    string ver;
+    EXPECT_TRUE(attrs.get(SessionAttr::CharacterId, id));
+    EXPECT_EQ(id, 10001);
+    EXPECT_TRUE(attrs.get(SessionAttr::IsGm, gm));
+    EXPECT_TRUE(gm);
+    EXPECT_TRUE(attrs.get(SessionAttr::ClientVersion, ver));
+    EXPECT_EQ(ver, "1.2.3");
+
+    // 类型不匹配或不存在
+    EXPECT_FALSE(attrs.get(SessionAttr::CharacterId, ver));
+    EXPECT_FALSE(attrs.get(SessionAttr::Level, id));
+    EXPECT_EQ(attrs.size(), 3u);
+}
+
+TEST(SessionAttrsTest, OverwriteKeepsSingleEntry) {
+    SessionAttrs attrs;
+    attrs.set(SessionAttr::Level, 1);
+    attrs.set(SessionAttr::Level, 2);
+    attrs.set(SessionAttr::Level, 2.5); // 换类型
+    EXPECT_EQ(attrs.size(), 1u);
+    ASSERT_NE(attrs.find<double>(SessionAttr::Level), nullptr);
+    EXPECT_DOUBLE_EQ(*attrs.find<double>(SessionAttr::Level), 2.5);
+    EXPECT_EQ(attrs.find<int64_t>(SessionAttr::Level), nullptr);
+}
+
+TEST(SessionAttrsTest, InternIsStable) {
+    AttrKey a = SessionAttrRegistry::intern("guild_id");
+    AttrKey b = SessionAttrRegistry::intern("guild_id");
+    AttrKey c = SessionAttrRegistry::intern("vip_level");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_GE(a.id, static_cast<uint16_t>(SessionAttr::kBuiltinCount));
+    EXPECT_EQ(SessionAttrRegistry::intern("level"), AttrKey(SessionAttr::Level));
+    EXPECT_EQ(SessionAttrRegistry::name(c), "vip_level");
+}
+
+TEST(SessionAttrsTest, OverflowAndErase) {
+    SessionAttrs attrs;
+    const size_t n = SessionAttrs::kInlineCapacity + 4;
+    for (size_t i = 0; i < n; ++i) {
+        attrs.set(AttrKey(static_cast<uint16_t>(100 + i)), static_cast<int64_t>(i));
+    }
+    EXPECT_EQ(attrs.size(), n);
+
+    EXPECT_TRUE(attrs.erase(AttrKey(100)));
+    EXPECT_TRUE(attrs.erase(AttrKey(static_cast<uint16_t>(100 + n - 1))));
+    EXPECT_FALSE(attrs.erase(AttrKey(100)));
+    EXPECT_EQ(attrs.size(), n - 2);
+    for (size_t i = 1; i + 1 < n; ++i) {
+        int64_t v = -1;
+        EXPECT_TRUE(attrs.get(AttrKey(static_cast<uint16_t>(100 + i)), v));
+        EXPECT_EQ(v, static_cast<int64_t>(i));
+    }
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "SessionSnapshot.h"
+#include "ResumeToken.h"
+#include "UserSessionCB.h"
+
+using namespace std;
+
+// UserSessionCB.cpp 通过它投递关闭通知；测试里没有 loop，保持为空
+EventLoop* g_eventLoop = nullptr;
+
+namespace {
+
+atomic<uint64_t> g_nextConn{900000};
+
+// 会话管理器是进程级单例：每个用例用自己的用户名和连接号，结束时把建过的会话都清掉
+class SessionSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char tmpl[] = "/tmp/session_snapshot_test_XXXXXX";
+        int fd = mkstemp(tmpl);
+        ASSERT_GE(fd, 0);
+        ::close(fd);
+        path = tmpl;
+    }
+
+    void TearDown() override {
+        for (const auto& token : tokens) Drop(token);
+        ::unlink(path.c_str());
+        ::unlink((path + ".tmp").c_str());
+    }
+
+    shared_ptr<UserSessionCB> Create(const string& username) {
+        SessionToken token = SessionToken::generate();
+        tokens.push_back(token);
+        return manager().createSession(token, username, -1, ++g_nextConn);
+    }
+
+    // 恢复出来的会话没有连接索引，先绑一个连接号再走断线清理
+    void Drop(const SessionToken& token) {
+        if (auto ses = manager().getSession(token)) {
+            uint64_t conn = ++g_nextConn;
+            manager().rebindSession(ses, -1, conn);
+            manager().onDisconnect(conn);
+        }
+    }
+
+    static UserSessionManager& manager() { return UserSessionManager::getInstance(); }
+
+    string path;
+    vector<SessionToken> tokens;
+};
+
+size_t FileSize(const string& path)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+} // namespace
+
+TEST_F(SessionSnapshotTest, RoundTripRestoresSessionsAndResumeKey) {
+    auto alice = Create("snap_rt_alice");
+    auto bob = Create("snap_rt_bob");
+    string resumeToken = issueResumeToken("snap_rt_alice", alice->getToken(), UserSessionCB::kDefaultTtl);
+    auto expireAt = alice->getExpireAt();
+
+    ASSERT_EQ(SaveSessionSnapshot(path), 2);
+    for (const auto& token : tokens) Drop(token);
+    ASSERT_EQ(manager().getSession(alice->getToken()), nullptr);
+
+    // 模拟新进程：换一把签名密钥，旧令牌验签失败；加载快照后恢复原密钥
+    unsigned char oldKey[kResumeKeySize];
+    getResumeKey(oldKey);
+    unsigned char otherKey[kResumeKeySize] = {};
+    otherKey[0] = static_cast<unsigned char>(oldKey[0] ^ 0xFF);
+    setResumeKey(otherKey);
+    ResumeClaims claims;
+    EXPECT_FALSE(verifyResumeToken(resumeToken, claims));
+
+    EXPECT_EQ(LoadSessionSnapshot(path), 2u);
+    ASSERT_TRUE(verifyResumeToken(resumeToken, claims));
+    EXPECT_EQ(claims.username, "snap_rt_alice");
+    EXPECT_EQ(claims.token, alice->getToken());
+
+    auto restored = manager().getSession(alice->getToken());
+    ASSERT_NE(restored, nullptr);
+    EXPECT_EQ(restored->getUsername(), "snap_rt_alice");
+    EXPECT_EQ(restored->getClientFd(), -1);
+    // 文件里时间是毫秒精度
+    EXPECT_EQ(chrono::duration_cast<chrono::milliseconds>(restored->getExpireAt().time_since_epoch()),
+              chrono::duration_cast<chrono::milliseconds>(expireAt.time_since_epoch()));
+    EXPECT_EQ(manager().getSessionByUser("snap_rt_bob"), manager().getSession(bob->getToken()));
+    EXPECT_NE(manager().getSession(bob->getToken()), nullptr);
+}
+
+TEST_F(SessionSnapshotTest, SkipsExpiredRecords) {
+    auto live = Create("snap_exp_live");
+    auto stale = Create("snap_exp_stale");
+    auto now = UserSessionCB::Clock::now();
+    stale->restoreTimes(now - chrono::hours(2), now - chrono::hours(2), now - chrono::seconds(1));
+
+    ASSERT_EQ(SaveSessionSnapshot(path), 2);
+    for (const auto& token : tokens) Drop(token);
+
+    EXPECT_EQ(LoadSessionSnapshot(path), 1u);
+    EXPECT_NE(manager().getSession(live->getToken()), nullptr);
+    EXPECT_EQ(manager().getSession(stale->getToken()), nullptr);
+    EXPECT_EQ(manager().getSessionByUser("snap_exp_stale"), nullptr);
+}
+
+TEST_F(SessionSnapshotTest, TruncatedFileKeepsWholeRecordsOnly) {
+    auto first = Create("snap_trunc_a");
+    auto second = Create("snap_trunc_b");
+    ASSERT_EQ(SaveSessionSnapshot(path), 2);
+    for (const auto& token : tokens) Drop(token);
+
+    // 砍掉最后一条记录用户名的末尾：读到长度字段后发现越界，只恢复前面完整的那条
+    size_t size = FileSize(path);
+    ASSERT_EQ(::truncate(path.c_str(), static_cast<off_t>(size - 3)), 0);
+    EXPECT_EQ(LoadSessionSnapshot(path), 1u);
+    bool firstBack = manager().getSession(first->getToken()) != nullptr;
+    bool secondBack = manager().getSession(second->getToken()) != nullptr;
+    EXPECT_NE(firstBack, secondBack);
+    for (const auto& token : tokens) Drop(token);
+
+    // 只剩半条定长部分
+    ASSERT_EQ(::truncate(path.c_str(), static_cast<off_t>(size - 3 - 20)), 0);
+    EXPECT_EQ(LoadSessionSnapshot(path), 1u);
+    for (const auto& token : tokens) Drop(token);
+
+    // 连文件头都不完整
+    ASSERT_EQ(::truncate(path.c_str(), 10), 0);
+    EXPECT_EQ(LoadSessionSnapshot(path), 0u);
+    EXPECT_EQ(manager().getSession(first->getToken()), nullptr);
+    EXPECT_EQ(manager().getSession(second->getToken()), nullptr);
+}
+
+TEST_F(SessionSnapshotTest, MissingOrForeignFileRestoresNothing) {
+    EXPECT_EQ(LoadSessionSnapshot(path + ".missing"), 0u);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    ASSERT_NE(f, nullptr);
+    vector<char> junk(256, 'x');
+    fwrite(junk.data(), 1, junk.size(), f);
+    fclose(f);
+    EXPECT_EQ(LoadSessionSnapshot(path), 0u);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include "ShardRouter.h"
+
+using namespace std;
+
+namespace {
+
+// 代替 DBConnPool 的假后端，只记一个名字
+struct FakeBackend {
+    string name;
+};
+
+using FakeRouter = ShardRouter<FakeBackend>;
+
+FakeRouter::ShardSpec MakeShard(const string& primary, const vector<string>& replicas = {})
+{
+    FakeRouter::ShardSpec spec;
+    spec.primary = make_shared<FakeBackend>(FakeBackend{primary});
+    for (const auto& r : replicas) {
+        spec.replicas.push_back(make_shared<FakeBackend>(FakeBackend{r}));
+    }
+    return spec;
+}
+
+} // namespace
+
+TEST(ShardRouterTest, RoutesKeysStablyAcrossAllShards) {
+    vector<FakeRouter::ShardSpec> shards;
+    for (int i = 0; i < 4; ++i) shards.push_back(MakeShard("p" + to_string(i)));
+    FakeRouter router(std::move(shards));
+
+    set<string> used;
+    for (int i = 0; i < 1000; ++i) {
+        string user = "player_" + to_string(i);
+        size_t shard = router.shardFor(user);
+        ASSERT_LT(shard, 4u);
+        EXPECT_EQ(router.shardFor(user), shard);
+        EXPECT_EQ(router.primary(user).name, "p" + to_string(shard));
+        used.insert(router.primary(user).name);
+    }
+    EXPECT_EQ(used.size(), 4u);
+}
+
+TEST(ShardRouterTest, AddingShardMovesOnlyAFraction) {
+    const int keys = 10000;
+    int moved = 0;
+    for (int i = 0; i < keys; ++i) {
+        uint64_t h = HashShardKey("player_" + to_string(i));
+        size_t before = JumpConsistentHash(h, 4);
+        size_t after = JumpConsistentHash(h, 5);
+        if (before != after) {
+            EXPECT_EQ(after, 4u); // 只会搬到新分片
+            ++moved;
+        }
+    }
+    // 理论上约 1/5
+    EXPECT_GT(moved, keys / 10);
+    EXPECT_LT(moved, keys * 3 / 10);
+}
+
+TEST(ShardRouterTest, ReaderUsesOnlyFreshEnoughReplicas) {
+    vector<FakeRouter::ShardSpec> shards;
+    shards.push_back(MakeShard("p0", {"r0", "r1"}));
+    FakeRouter router(std::move(shards));
+
+    // 延迟未知时读主库
+    EXPECT_EQ(router.reader("alice", chrono::seconds(5)).name, "p0");
+
+    router.setReplicaLag(0, 0, chrono::milliseconds(200));
+    router.setReplicaLag(0, 1, chrono::milliseconds(8000));
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(router.reader("alice", chrono::seconds(5)).name, "r0");
+    }
+
+    router.setReplicaLag(0, 1, chrono::milliseconds(100));
+    set<string> seen;
+    for (int i = 0; i < 4; ++i) {
+        seen.insert(router.reader("alice", chrono::seconds(5)).name);
+    }
+    EXPECT_EQ(seen, (set<string>{"r0", "r1"}));
+
+    // 要求比所有副本都新时回到主库；复制中断（负值）的副本不参与
+    EXPECT_EQ(router.reader("alice", chrono::milliseconds(50)).name, "p0");
+    router.setReplicaLag(0, 0, chrono::milliseconds(-1));
+    router.setReplicaLag(0, 1, chrono::milliseconds(-1));
+    EXPECT_EQ(router.reader("alice", chrono::seconds(5)).name, "p0");
+}
+
+TEST(ShardRouterTest, RejectsEmptyTopology) {
+    EXPECT_THROW(FakeRouter(vector<FakeRouter::ShardSpec>{}), invalid_argument);
+    vector<FakeRouter::ShardSpec> shards(1);
+    EXPECT_THROW(FakeRouter(std::move(shards)), invalid_argument);
+}
+
+TEST(ShardRouterTest, ParsesTopology) {
+    auto shards = ParseShardTopology("tcp://a:3306|tcp://a1:3306|tcp://a2:3306;;tcp://b:3306;");
+    ASSERT_EQ(shards.size(), 2u);
+    EXPECT_EQ(shards[0].primary, "tcp://a:3306");
+    EXPECT_EQ(shards[0].replicas, (vector<string>{"tcp://a1:3306", "tcp://a2:3306"}));
+    EXPECT_EQ(shards[1].primary, "tcp://b:3306");
+    EXPECT_TRUE(shards[1].replicas.empty());
+    EXPECT_TRUE(ParseShardTopology("").empty());
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "TimingWheel.h"
+
+using namespace std;
+
+TEST(TimingWheelTest, ExpiresAfterRequestedTicks) {
+    TimingWheel<int> wheel(8);
+    wheel.add(1, 1);
+    wheel.add(3, 3);
+    wheel.add(8, 8);
+
+    vector<pair<int, int>> fired; // (tick, item)
+    for (int t = 1; t <= 8; ++t) {
+        wheel.tick(100, [&](int& item) { fired.emplace_back(t, item); });
+    }
+    ASSERT_EQ(fired.size(), 3u);
+    EXPECT_EQ(fired[0], make_pair(1, 1));
+    EXPECT_EQ(fired[1], make_pair(3, 3));
+    EXPECT_EQ(fired[2], make_pair(8, 8));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, DelaysLongerThanOneRevolution) {
+    TimingWheel<int> wheel(4);
+    wheel.add(9, 9);
+    wheel.add(0, 0); // 0 按 1 处理
+
+    vector<int> firedAt;
+    for (int t = 1; t <= 12; ++t) {
+        wheel.tick(100, [&](int& item) { if (item == 9) firedAt.push_back(t); });
+    }
+    ASSERT_EQ(firedAt.size(), 1u);
+    EXPECT_EQ(firedAt[0], 9);
+}
+
+TEST(TimingWheelTest, BoundedPerTickCarriesBacklog) {
+    TimingWheel<int> wheel(4);
+    for (int i = 0; i < 10; ++i) {
+        wheel.add(i, 1);
+    }
+
+    int count = 0;
+    EXPECT_EQ(wheel.tick(4, [&](int&) { ++count; }), 4u);
+    EXPECT_EQ(wheel.backlog(), 6u);
+    EXPECT_EQ(wheel.tick(4, [&](int&) { ++count; }), 4u);
+    EXPECT_EQ(wheel.tick(4, [&](int&) { ++count; }), 2u);
+    EXPECT_EQ(count, 10);
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimingWheelTest, CallbackCanReschedule) {
+    TimingWheel<int> wheel(4);
+    wheel.add(1, 2);
+
+    int fires = 0;
+    for (int t = 1; t <= 10; ++t) {
+        wheel.tick(100, [&](int& item) {
+            ++fires;
+            if (fires < 3) wheel.add(item, 4); // 模拟会话被续期
+        });
+    }
+    EXPECT_EQ(fires, 3); // 第 2、6、10 个刻度
+    EXPECT_EQ(wheel.size(), 0u);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "UserInfoCache.h"
+
+using namespace std;
+
+TEST(UserInfoCacheTest, PositiveAndNegativeTtl) {
+    UserInfoCache cache(64);
+    auto t0 = UserInfoCache::Clock::now();
+
+    cache.put("alice", CachedUserInfo{true, "hash-a"}, cache.loadTicket("alice"), t0);
+    cache.put("ghost", CachedUserInfo{false, ""}, cache.loadTicket("ghost"), t0);
+
+    CachedUserInfo info;
+    ASSERT_TRUE(cache.get("alice", info, t0 + chrono::seconds(10)));
+    EXPECT_TRUE(info.exists);
+    EXPECT_EQ(info.pwdHash, "hash-a");
+    ASSERT_TRUE(cache.get("ghost", info, t0 + chrono::seconds(10)));
+    EXPECT_FALSE(info.exists);
+
+    // 负缓存先过期，正向条目还在
+    EXPECT_FALSE(cache.get("ghost", info, t0 + UserInfoCache::kNegativeTtl + chrono::seconds(1)));
+    EXPECT_TRUE(cache.get("alice", info, t0 + UserInfoCache::kNegativeTtl + chrono::seconds(1)));
+    EXPECT_FALSE(cache.get("alice", info, t0 + UserInfoCache::kPositiveTtl + chrono::seconds(1)));
+}
+
+TEST(UserInfoCacheTest, InvalidateDropsEntryAndStaleLoad) {
+    UserInfoCache cache(64);
+    cache.put("bob", CachedUserInfo{false, ""}, cache.loadTicket("bob"));
+
+    uint64_t ticket = cache.loadTicket("bob"); // 模拟查库开始
+    cache.invalidate("bob");                   // 期间注册成功
+    cache.put("bob", CachedUserInfo{false, ""}, ticket);
+
+    CachedUserInfo info;
+    EXPECT_FALSE(cache.get("bob", info));
+    EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(UserInfoCacheTest, EvictsLeastRecentlyUsed) {
+    UserInfoCache cache(16); // 每个分片 1 条
+    for (int i = 0; i < 200; ++i) {
+        string name = "user" + to_string(i);
+        cache.put(name, CachedUserInfo{true, "h"}, cache.loadTicket(name));
+    }
+    EXPECT_LE(cache.size(), 16u);
+
+    CachedUserInfo info;
+    EXPECT_TRUE(cache.get("user199", info)); // 最后写入的一定还在
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <vector>
+#include "WriteBehindStore.h"
+#include "FakeBatchWriter.h"
+
+using namespace std;
+
+namespace {
+
+const TableSchema kTable{"t_test", {"id"}, {"gold"}};
+
+RowImage Row(int64_t id, int64_t gold)
+{
+    return RowImage{&kTable, {id}, {gold}, {}};
+}
+
+} // namespace
+
+TEST(WriteBehindStoreTest, CoalescesUpdatesToSameRow) {
+    FakeWriter fake;
+    WriteBehindStore store("test_coalesce", fake.writer(), ManualOptions());
+
+    for (int64_t gold = 1; gold <= 10; ++gold) {
+        ASSERT_TRUE(store.put(Row(1, gold)));
+    }
+    ASSERT_TRUE(store.put(Row(2, 5)));
+    EXPECT_EQ(store.pendingRows(), 2u);
+
+    ASSERT_TRUE(store.flush());
+    ASSERT_EQ(fake.batches.size(), 1u);
+    ASSERT_EQ(fake.batches[0].size(), 2u);
+    for (auto& row : fake.batches[0]) {
+        if (get<int64_t>(row.keys[0]) == 1) {
+            EXPECT_EQ(get<int64_t>(row.values[0]), 10); // 只写最后一次
+        }
+    }
+    EXPECT_EQ(store.pendingRows(), 0u);
+}
+
+TEST(WriteBehindStoreTest, BatchesNeverExceedBatchRows) {
+    FakeWriter fake;
+    WriteBehindStore store("test_split", fake.writer(), ManualOptions(4));
+
+    // 攒够 4 行会唤醒后台线程提前 flush，不管谁来写，每批都不超过 batchRows
+    for (int64_t id = 0; id < 10; ++id) {
+        ASSERT_TRUE(store.put(Row(id, id)));
+    }
+    ASSERT_TRUE(store.flush());
+    EXPECT_EQ(fake.rows(), 10u);
+    lock_guard<mutex> lk(fake.mu);
+    for (auto& batch : fake.batches) {
+        EXPECT_LE(batch.size(), 4u);
+    }
+}
+
+TEST(WriteBehindStoreTest, FailedBatchIsRequeuedWithoutOverwritingNewerPut) {
+    FakeWriter fake;
+    WriteBehindStore store("test_requeue", fake.writer(), ManualOptions());
+
+    ASSERT_TRUE(store.put(Row(1, 100)));
+    ASSERT_TRUE(store.put(Row(2, 200)));
+    fake.failing = true;
+    EXPECT_FALSE(store.flush());
+    EXPECT_EQ(store.pendingRows(), 2u);
+
+    ASSERT_TRUE(store.put(Row(1, 101))); // 失败后又有新写入，应以新的为准
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+    ASSERT_EQ(fake.rows(), 2u);
+    for (auto& row : fake.batches[0]) {
+        int64_t id = get<int64_t>(row.keys[0]);
+        EXPECT_EQ(get<int64_t>(row.values[0]), id == 1 ? 101 : 200);
+    }
+}
+
+TEST(WriteBehindStoreTest, RejectsNewRowsWhenFullButStillCoalesces) {
+    FakeWriter fake;
+    fake.failing = true; // 后台线程即使被唤醒也写不进去，失败的行重新排队仍占名额
+    WriteBehindStore store("test_backpressure", fake.writer(), ManualOptions(2, 2));
+
+    ASSERT_TRUE(store.put(Row(1, 1)));
+    ASSERT_TRUE(store.put(Row(2, 2)));
+    EXPECT_FALSE(store.put(Row(3, 3), chrono::milliseconds(10)));
+    EXPECT_TRUE(store.put(Row(1, 9))); // 已在队列里（或正在写）的行不受背压限制
+    EXPECT_FALSE(store.flush());
+    EXPECT_EQ(store.pendingRows(), 2u);
+    EXPECT_FALSE(store.put(Row(3, 3), chrono::milliseconds(10)));
+}
+
+TEST(WriteBehindStoreTest, RowsBeingWrittenCountAgainstTheLimit) {
+    mutex mu;
+    condition_variable cv;
+    bool entered = false;
+    bool release = false;
+    auto blocking = [&](const TableSchema&, const vector<RowImage>&) {
+        unique_lock<mutex> lk(mu);
+        entered = true;
+        cv.notify_all();
+        cv.wait(lk, [&]() { return release; });
+        return true;
+    };
+    // 攒够 batchRows 由后台线程 flush，写入卡在 blocking 里
+    WriteBehindStore store("test_inflight", blocking, ManualOptions(2, 2));
+    ASSERT_TRUE(store.put(Row(1, 1)));
+    ASSERT_TRUE(store.put(Row(2, 2)));
+    {
+        unique_lock<mutex> lk(mu);
+        cv.wait(lk, [&]() { return entered; });
+    }
+    // 两行都在写，队列虽然空了，名额还没释放
+    EXPECT_EQ(store.pendingRows(), 2u);
+    EXPECT_FALSE(store.put(Row(3, 3), chrono::milliseconds(10)));
+    EXPECT_TRUE(store.put(Row(1, 5))); // 正在写的行可以排下一份镜像
+
+    {
+        lock_guard<mutex> lk(mu);
+        release = true;
+    }
+    cv.notify_all();
+    auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+    while (store.pendingRows() != 1 && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    EXPECT_EQ(store.pendingRows(), 1u); // 只剩 Row(1, 5)
+    EXPECT_TRUE(store.put(Row(3, 3)));
+}
+
+TEST(WriteBehindStoreTest, StopFlushesPendingRows) {
+    FakeWriter fake;
+    {
+        WriteBehindStore store("test_stop", fake.writer(), ManualOptions());
+        ASSERT_TRUE(store.put(Row(1, 1)));
+        ASSERT_TRUE(store.put(Row(2, 2)));
+        store.stop();
+        EXPECT_FALSE(store.put(Row(3, 3)));
+    }
+    EXPECT_EQ(fake.rows(), 2u);
+}
+
+TEST(WriteBehindStoreTest, RowIdDistinguishesKeyBoundaries) {
+    static const TableSchema twoKeys{"t_two", {"a", "b"}, {"v"}};
+    EXPECT_NE(RowId(twoKeys, {string("ab"), string("c")}), RowId(twoKeys, {string("a"), string("bc")}));
+    EXPECT_NE(RowId(kTable, {int64_t(1)}), RowId(twoKeys, {int64_t(1)}));
+    EXPECT_EQ(RowId(kTable, {int64_t(7)}), RowId(Row(7, 0)));
+}
+
+TEST(WriteBehindStoreTest, LastCleanFlushOnlyAdvancesOnSuccess) {
+    FakeWriter fake;
+    WriteBehindStore store("test_clean", fake.writer(), ManualOptions());
+
+    ASSERT_TRUE(store.put(Row(1, 1)));
+    auto putAt = chrono::steady_clock::now();
+    fake.failing = true;
+    EXPECT_FALSE(store.flush());
+    EXPECT_LT(store.lastCleanFlush(), putAt);
+
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+    EXPECT_GT(store.lastCleanFlush(), putAt); // put 之后开始的成功 flush，之前的改动都已落库
+}
+
+namespace {
+
+const TableSchema kWide{"t_wide", {"id"}, {"a", "b", "c"}};
+
+RowImage Partial(int64_t id, size_t column, int64_t value)
+{
+    RowImage row{&kWide, {id}, {int64_t(0), int64_t(0), int64_t(0)}, {}};
+    row.values[column] = value;
+    row.dirty.set(column);
+    return row;
+}
+
+} // namespace
+
+TEST(WriteBehindStoreTest, PartialUpdatesMergeDirtyColumns) {
+    RowImage base = Partial(1, 0, 10);
+    MergeRowImage(base, Partial(1, 2, 30));
+    EXPECT_EQ(base.dirty.to_ullong(), 0b101u);
+    EXPECT_EQ(get<int64_t>(base.values[0]), 10);
+    EXPECT_EQ(get<int64_t>(base.values[2]), 30);
+
+    // 叠加到整行上仍是整行，只覆盖脏列
+    RowImage full{&kWide, {int64_t(1)}, {int64_t(1), int64_t(2), int64_t(3)}, {}};
+    MergeRowImage(full, Partial(1, 1, 20));
+    EXPECT_FALSE(full.isPartial());
+    EXPECT_EQ(get<int64_t>(full.values[0]), 1);
+    EXPECT_EQ(get<int64_t>(full.values[1]), 20);
+
+    // 整行覆盖部分列
+    MergeRowImage(base, RowImage{&kWide, {int64_t(1)}, {int64_t(7), int64_t(8), int64_t(9)}, {}});
+    EXPECT_FALSE(base.isPartial());
+    EXPECT_EQ(get<int64_t>(base.values[0]), 7);
+}
+
+TEST(WriteBehindStoreTest, GroupsBatchesByDirtyColumnSet) {
+    FakeWriter fake;
+    WriteBehindStore store("test_group", fake.writer(), ManualOptions());
+
+    ASSERT_TRUE(store.put(Partial(1, 0, 1)));
+    ASSERT_TRUE(store.put(Partial(2, 0, 2)));
+    ASSERT_TRUE(store.put(Partial(3, 1, 3)));
+    ASSERT_TRUE(store.put(RowImage{&kWide, {int64_t(4)}, {int64_t(4), int64_t(4), int64_t(4)}, {}}));
+    ASSERT_TRUE(store.flush());
+
+    ASSERT_EQ(fake.batches.size(), 3u); // {a}、{b}、整行
+    for (auto& batch : fake.batches) {
+        for (auto& row : batch) {
+            EXPECT_EQ(row.dirty, batch.front().dirty);
+        }
+    }
+}
+
+TEST(WriteBehindStoreTest, RequeuedPartialRowKeepsOlderDirtyColumns) {
+    FakeWriter fake;
+    WriteBehindStore store("test_requeue_partial", fake.writer(), ManualOptions());
+
+    ASSERT_TRUE(store.put(Partial(1, 0, 10)));
+    fake.failing = true;
+    EXPECT_FALSE(store.flush());
+    ASSERT_TRUE(store.put(Partial(1, 1, 20)));
+    fake.failing = false;
+    ASSERT_TRUE(store.flush());
+
+    ASSERT_EQ(fake.rows(), 1u);
+    const RowImage& row = fake.batches[0][0];
+    EXPECT_EQ(row.dirty.to_ullong(), 0b011u);
+    EXPECT_EQ(get<int64_t>(row.values[0]), 10);
+    EXPECT_EQ(get<int64_t>(row.values[1]), 20);
+}
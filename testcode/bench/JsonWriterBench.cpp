@@ -0,0 +1,70 @@
+// 对比 nlohmann::json::dump 与 JsonWriter / JsonTemplate 在热点响应上的耗时
+// 载荷与 LoginProc.cpp 登录成功响应、UserSessionManager::buildSessionExpiredResponse 一致
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "json.hpp"
+#include "JsonWriter.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+static const string kToken = "0005f3c2a1b4d6e80000000000000001a3f19c2d4e5b6a7c9d8e7f6a5b4c3d2e1";
+
+template <typename F>
+static void Bench(const char* name, int iterations, F&& fn)
+{
+    size_t sink = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink += fn().size();
+    }
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    printf("%-36s %8.1f ns/op  (checksum %zu)\n", name, double(ns) / iterations, sink);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    Bench("login: json + dump", iterations, []() {
+        nlohmann::json j = {
+            {"status", "success"},
+            {"message", "Login successful"},
+            {"token", kToken}
+        };
+        return j.dump();
+    });
+
+    Bench("login: JsonWriter", iterations, []() {
+        string out;
+        out.reserve(128);
+        JsonWriter w(out);
+        w.beginObject()
+            .field("status", "success")
+            .field("message", "Login successful")
+            .field("token", kToken)
+         .endObject();
+        return out;
+    });
+
+    static const JsonTemplate kLogin(R"({"status":"success","message":"Login successful","token":"${}"})");
+    Bench("login: JsonTemplate", iterations, []() {
+        return kLogin.render({kToken});
+    });
+
+    Bench("session expired: json + dump", iterations, []() {
+        nlohmann::json j;
+        j["error"] = "session_expired";
+        j["message"] = "Your session has expired. Please login again.";
+        j["token"] = kToken;
+        return j.dump();
+    });
+
+    static const JsonTemplate kExpired(
+        R"({"error":"session_expired","message":"Your session has expired. Please login again.","token":"${}"})");
+    Bench("session expired: JsonTemplate", iterations, []() {
+        return kExpired.render({kToken});
+    });
+    return 0;
+}
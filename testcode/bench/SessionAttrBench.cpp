@@ -0,0 +1,72 @@
+// 会话属性存取基准：模拟每条游戏消息读 3 个属性、写 1 个属性
+// 对比旧的 unordered_map<string, variant> 与 SessionAttrs（AttrKey + 扁平数组）
+// 用法：./SessionAttrBench [messages]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include "SessionAttrs.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+using Attr = variant<int64_t, double, bool, string>;
+
+static void RunStringMap(int messages)
+{
+    unordered_map<string, Attr> attrs;
+    attrs["character_id"] = int64_t(10001);
+    attrs["server_id"] = int64_t(3);
+    attrs["scene_id"] = int64_t(42);
+    attrs["level"] = int64_t(1);
+    attrs["is_gm"] = false;
+    attrs["client_version"] = string("1.2.3");
+
+    int64_t sink = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < messages; ++i) {
+        sink += get<int64_t>(attrs["character_id"]);
+        sink += get<int64_t>(attrs["scene_id"]);
+        sink += get<bool>(attrs["is_gm"]) ? 1 : 0;
+        attrs["level"] = int64_t(i & 127);
+    }
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    printf("%-28s %7.1f ns/msg  (sink=%lld)\n", "unordered_map<string,variant>", double(ns) / messages, (long long)sink);
+}
+
+static void RunSessionAttrs(int messages)
+{
+    SessionAttrs attrs;
+    attrs.set(SessionAttr::CharacterId, 10001);
+    attrs.set(SessionAttr::ServerId, 3);
+    attrs.set(SessionAttr::SceneId, 42);
+    attrs.set(SessionAttr::Level, 1);
+    attrs.set(SessionAttr::IsGm, false);
+    attrs.set(SessionAttr::ClientVersion, "1.2.3");
+
+    int64_t sink = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < messages; ++i) {
+        int64_t v = 0;
+        bool gm = false;
+        attrs.get(SessionAttr::CharacterId, v);
+        sink += v;
+        attrs.get(SessionAttr::SceneId, v);
+        sink += v;
+        attrs.get(SessionAttr::IsGm, gm);
+        sink += gm ? 1 : 0;
+        attrs.set(SessionAttr::Level, i & 127);
+    }
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    printf("%-28s %7.1f ns/msg  (sink=%lld)\n", "SessionAttrs", double(ns) / messages, (long long)sink);
+}
+
+int main(int argc, char** argv)
+{
+    int messages = argc > 1 ? atoi(argv[1]) : 5000000;
+    RunStringMap(messages);
+    RunSessionAttrs(messages);
+    return 0;
+}
@@ -0,0 +1,122 @@
+// 会话表并发基准：多线程同时登录(插入)与查询，对比单把大锁的 unordered_map 与 ShardedMap
+// 另有一个线程模拟过期扫描：大锁版本整表遍历，分片版本逐分片遍历
+// 用法：./SessionTableBench [threads] [opsPerThread]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "SessionToken.h"
+#include "ShardedMap.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+using Value = shared_ptr<int>;
+
+class GlobalLockTable {
+public:
+    void insert(const SessionToken& k, Value v) { lock_guard<mutex> lk(mu_); map_[k] = std::move(v); }
+    bool find(const SessionToken& k, Value& out) {
+        lock_guard<mutex> lk(mu_);
+        auto it = map_.find(k);
+        if (it == map_.end()) return false;
+        out = it->second;
+        return true;
+    }
+    void sweep() {
+        lock_guard<mutex> lk(mu_);
+        size_t n = 0;
+        for (auto& kv : map_) n += (*kv.second == -1);
+        sink_ += n;
+    }
+private:
+    mutex mu_;
+    unordered_map<SessionToken, Value, SessionTokenHash> map_;
+    size_t sink_ = 0;
+};
+
+class ShardedTable {
+public:
+    void insert(const SessionToken& k, Value v) { map_.insertOrAssign(k, std::move(v)); }
+    bool find(const SessionToken& k, Value& out) { return map_.find(k, out); }
+    void sweep() {
+        for (size_t s = 0; s < Map::shardCount(); ++s) {
+            size_t n = 0;
+            map_.forEachInShard(s, [&n](const SessionToken&, const Value& v) { n += (*v == -1); });
+            sink_ += n;
+        }
+    }
+private:
+    using Map = ShardedMap<SessionToken, Value, SessionTokenHash, 64>;
+    Map map_;
+    size_t sink_ = 0;
+};
+
+static SessionToken RandomToken(mt19937_64& rng)
+{
+    SessionToken t;
+    for (size_t i = 0; i < SessionToken::kSize; i += 8) {
+        uint64_t r = rng();
+        memcpy(t.bytes.data() + i, &r, 8);
+    }
+    return t;
+}
+
+template <typename Table>
+static void Run(const char* name, int threads, int opsPerThread)
+{
+    Table table;
+    // 预热：10 万在线会话
+    mt19937_64 seed(42);
+    vector<SessionToken> warm;
+    for (int i = 0; i < 100000; ++i) {
+        warm.push_back(RandomToken(seed));
+        table.insert(warm.back(), make_shared<int>(i));
+    }
+
+    atomic<bool> stop{false};
+    thread sweeper([&]() {
+        while (!stop.load()) {
+            table.sweep();
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+    });
+
+    auto start = Clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            mt19937_64 rng(1000 + t);
+            Value out;
+            for (int i = 0; i < opsPerThread; ++i) {
+                if (i % 10 == 0) {
+                    table.insert(RandomToken(rng), make_shared<int>(i)); // 10% 登录
+                } else {
+                    table.find(warm[rng() % warm.size()], out);          // 90% 查询
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    stop = true;
+    sweeper.join();
+
+    double totalOps = double(threads) * opsPerThread;
+    printf("%-18s threads=%-3d %8.2f Mops/s  %7.1f ns/op\n", name, threads, totalOps / ns * 1e3, double(ns) / opsPerThread);
+}
+
+int main(int argc, char** argv)
+{
+    int threads = argc > 1 ? atoi(argv[1]) : int(thread::hardware_concurrency());
+    int ops = argc > 2 ? atoi(argv[2]) : 500000;
+    Run<GlobalLockTable>("global mutex", threads, ops);
+    Run<ShardedTable>("sharded (64)", threads, ops);
+    return 0;
+}